@@ -58,4 +58,45 @@ inline static _Q15 abs_Q15(const _Q15 arg)
     return res;
 }
 
+/**
+ * @brief Modified calculation of absolute of an array in Q0.15 format
+ * 
+ * Same as abs_Q15() applied element-wise, i.e. 0x8000 is mapped to 0x7FFF
+ * @note This function executes in 3 + 6 * len CPU clock cycles (using compiler option -o2)
+ * @param src   Pointer to array in Q0.15 format
+ * @param dst   Pointer to modified absolute array in Q0.15 format
+ * @param len   Number of array elements
+ */
+inline static void abs_aQ15(
+                            const _Q15 * src,
+                            _Q15 * dst,
+                            const uint16_t len)
+{
+    // Array element
+    _Q15 val;
+    
+    // Bit mask
+    _Q15 mask;
+    
+    // Minimum of Q0.15
+    _Q15 min;
+    
+    __asm__ volatile(
+            "\
+        mov     #0x8000, %[min]                     ;Minimum of Q0.15 \n \
+        do      %[len], abs_aQ15_end_%=             ;Init Loop \n \
+        mov     [%[src]++], %[val]                  ;Load array element \n \
+        cpsne   %[val], %[min]                      ;Compare val and minimum, skip if not equal \n \
+        mov     #0x7FFF, %[val]                     ;Correct val to get the desired result \n \
+        asr     %[val], #15, %[mask]                ;Use bitmask to calculate two's complement of val \n \
+        add     %[mask], %[val], %[val]             ;Subtract one (step 2 of two's complement calculation) \n \
+        abs_aQ15_end_%=:                            ;\n \
+        xor     %[mask], %[val], [%[dst]++]         ;Invert bit-wise for negative numbers and store result \n \
+        ; 2 + 6 * len cycles total, 1 DO level"
+            : [src] "+r"(src), [dst] "+r"(dst), [val] "=&r"(val), [mask] "=&r"(mask), [min] "=&r"(min) /*out*/
+            : [len] "r"(len - 1) /*in*/
+            : "memory" /*clobbered*/
+            );
+}
+
 #endif
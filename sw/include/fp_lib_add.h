@@ -0,0 +1,78 @@
+/*
+Copyright (C) 2022 Andreas Lagler
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file fp_lib_add.h
+ * @brief Addition and subtraction routines for fixed point types
+ *
+ * This file is part of FP-Lib Fixed-point math library for dsPIC33 family of Microchip dsPIC digital signal controllers
+ */
+
+#ifndef FP_LIB_ADD_H
+#define	FP_LIB_ADD_H
+
+#include "fp_lib_types.h"
+
+#include <stdint.h>
+
+/**
+ * @brief Saturating addition of two scalars in Q0.31 format
+ * @note The result is saturated to the range of Q0.31
+ * @note This function executes in 9 CPU clock cycles (using compiler option -o2)
+ * @param arg1 Summand in Q0.31 format
+ * @param arg2 Summand in Q0.31 format
+ * @return Sum in Q0.31 format
+ */
+inline static _Q31 add_Q31_Sat(const _Q31 arg1, const _Q31 arg2)
+{
+    // Wrap-around sum
+    const _Q31 res = (_Q31) ((uint32_t) arg1 + (uint32_t) arg2);
+
+    // Overflow occurred if both summands have the same sign and the sign of the sum differs
+    if (((arg1 ^ res) & (arg2 ^ res)) < 0)
+    {
+        // Saturate towards the sign of the summands
+        return (arg1 < 0) ? INT32_MIN : INT32_MAX;
+    }
+
+    return res;
+}
+
+/**
+ * @brief Saturating subtraction of two scalars in Q0.31 format
+ * @note The result is saturated to the range of Q0.31
+ * @note This function executes in 9 CPU clock cycles (using compiler option -o2)
+ * @param arg1 Minuend in Q0.31 format
+ * @param arg2 Subtrahend in Q0.31 format
+ * @return Difference in Q0.31 format
+ */
+inline static _Q31 sub_Q31_Sat(const _Q31 arg1, const _Q31 arg2)
+{
+    // Wrap-around difference
+    const _Q31 res = (_Q31) ((uint32_t) arg1 - (uint32_t) arg2);
+
+    // Overflow occurred if the operands have different signs and the sign of the difference differs from the minuend
+    if (((arg1 ^ arg2) & (arg1 ^ res)) < 0)
+    {
+        // Saturate towards the sign of the minuend
+        return (arg1 < 0) ? INT32_MIN : INT32_MAX;
+    }
+
+    return res;
+}
+
+#endif
@@ -0,0 +1,302 @@
+/*
+Copyright (C) 2022 Andreas Lagler
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file fp_lib_complex.h
+ * @brief Complex arithmetic routines for fixed point types
+ *
+ * This file is part of FP-Lib Fixed-point math library for dsPIC33 family of Microchip dsPIC digital signal controllers
+ */
+
+#ifndef FP_LIB_COMPLEX_H
+#define	FP_LIB_COMPLEX_H
+
+#include "fp_lib_types.h"
+
+#include <stdint.h>
+
+/**
+ * @brief Multiplication of two complex scalars in Q0.15 format
+ *
+ * re = ar * br - ai * bi \n
+ * im = ar * bi + ai * br
+ *
+ * Real and imaginary part are calculated in parallel in accA and accB.
+ *
+ * @note The multiplication result is rounded according to CORCON.RND and saturated to Q0.15
+ * @note This function executes in 8 CPU clock cycles (using compiler option -o2)
+ * @param arg1 Complex factor in Q0.15 format
+ * @param arg2 Complex factor in Q0.15 format
+ * @return Multiplication result in Q0.15 format
+ */
+inline static _CQ15 cmul_Q15(const _CQ15 arg1, const _CQ15 arg2)
+{
+    _CQ15 res;
+
+    __asm__ volatile(
+            "\
+        mpy     %[ar] * %[br], A                    ;ar * br in A \n \
+        mpy     %[ar] * %[bi], B                    ;ar * bi in B \n \
+        msc     %[ai] * %[bi], A                    ;Subtract ai * bi from A \n \
+        mac     %[ai] * %[br], B                    ;Add ai * br to B \n \
+        sac.r   A, #0, %[re]                        ;Store real part \n \
+        sac.r   B, #0, %[im]                        ;Store imaginary part \n \
+        ;6 cycles total"
+            : [re] "=r"(res.re), [im] "=r"(res.im) /*out*/
+            : [ar] "z"(arg1.re), [ai] "z"(arg1.im), [br] "z"(arg2.re), [bi] "z"(arg2.im) /*in*/
+            : /*clobbered*/
+            );
+
+    return res;
+}
+
+/**
+ * @brief Multiplication of a complex scalar with the complex conjugate of another complex scalar in Q0.15 format
+ *
+ * re = ar * br + ai * bi \n
+ * im = ai * br - ar * bi
+ *
+ * Real and imaginary part are calculated in parallel in accA and accB.
+ *
+ * @note The multiplication result is rounded according to CORCON.RND and saturated to Q0.15
+ * @note This function executes in 8 CPU clock cycles (using compiler option -o2)
+ * @param arg1 Complex factor in Q0.15 format
+ * @param arg2 Complex factor in Q0.15 format
+ * @return Multiplication result in Q0.15 format
+ */
+inline static _CQ15 cmulConj_Q15(const _CQ15 arg1, const _CQ15 arg2)
+{
+    _CQ15 res;
+
+    __asm__ volatile(
+            "\
+        mpy     %[ar] * %[br], A                    ;ar * br in A \n \
+        mpy.n   %[ar] * %[bi], B                    ;-ar * bi in B \n \
+        mac     %[ai] * %[bi], A                    ;Add ai * bi to A \n \
+        mac     %[ai] * %[br], B                    ;Add ai * br to B \n \
+        sac.r   A, #0, %[re]                        ;Store real part \n \
+        sac.r   B, #0, %[im]                        ;Store imaginary part \n \
+        ;6 cycles total"
+            : [re] "=r"(res.re), [im] "=r"(res.im) /*out*/
+            : [ar] "z"(arg1.re), [ai] "z"(arg1.im), [br] "z"(arg2.re), [bi] "z"(arg2.im) /*in*/
+            : /*clobbered*/
+            );
+
+    return res;
+}
+
+/**
+ * @brief Element-wise multiplication of two complex arrays in Q0.15 format
+ *
+ * dst[k] = src1[k] * src2[k]
+ *
+ * Real and imaginary part are calculated in parallel in accA and accB, both source arrays are prefetched while multiplying.
+ *
+ * @note The multiplication result is rounded according to CORCON.RND and saturated to Q0.15
+ * @note src1 must be located in X data memory, src2 must be located in Y data memory
+ * @note One element beyond the end of the source arrays is read (but not used) by the final prefetch
+ * @note This function executes in 6 + 6 * len CPU clock cycles (using compiler option -o2)
+ * @param src1  Pointer to complex array in Q0.15 format
+ * @param src2  Pointer to complex array in Q0.15 format
+ * @param dst   Pointer to complex multiplication result array in Q0.15 format
+ * @param len   Number of array elements
+ */
+inline static void cmul_aQ15(
+                                 const _CQ15 * src1,
+                                 const _CQ15 * src2,
+                                 _CQ15 * dst,
+                                 const uint16_t len)
+{
+    // Prefetched real and imaginary parts
+    _Q15 ar;
+    _Q15 ai;
+    _Q15 br;
+    _Q15 bi;
+
+    __asm__ volatile(
+            "\
+        clr     A, [%[src1]]+=2, %[ar], [%[src2]]+=2, %[br] ;Prefetch real parts of first elements \n \
+        clr     B, [%[src1]]+=2, %[ai], [%[src2]]+=2, %[bi] ;Prefetch imaginary parts of first elements \n \
+        do      %[len], cmul_aQ15_end_%=            ;Init Loop \n \
+        mpy     %[ar] * %[br], A                    ;ar * br in A \n \
+        mpy     %[ar] * %[bi], B, [%[src1]]+=2, %[ar] ;ar * bi in B, prefetch next ar \n \
+        mac     %[ai] * %[br], B, [%[src2]]+=2, %[br] ;Add ai * br to B, prefetch next br \n \
+        msc     %[ai] * %[bi], A, [%[src1]]+=2, %[ai], [%[src2]]+=2, %[bi] ;Subtract ai * bi from A, prefetch next ai and bi \n \
+        sac.r   A, #0, [%[dst]++]                   ;Store real part \n \
+        cmul_aQ15_end_%=:                           ;\n \
+        sac.r   B, #0, [%[dst]++]                   ;Store imaginary part \n \
+        ; 4 + 6 * len cycles total, 1 DO level"
+            : [src1] "+x"(src1), [src2] "+y"(src2), [dst] "+r"(dst),
+              [ar] "=&z"(ar), [ai] "=&z"(ai), [br] "=&z"(br), [bi] "=&z"(bi) /*out*/
+            : [len] "r"(len - 1) /*in*/
+            : "memory" /*clobbered*/
+            );
+}
+
+/**
+ * @brief Element-wise multiplication of a complex array with the complex conjugate of another complex array in Q0.15 format
+ *
+ * dst[k] = src1[k] * conj(src2[k])
+ *
+ * Real and imaginary part are calculated in parallel in accA and accB, both source arrays are prefetched while multiplying.
+ *
+ * @note The multiplication result is rounded according to CORCON.RND and saturated to Q0.15
+ * @note src1 must be located in X data memory, src2 must be located in Y data memory
+ * @note One element beyond the end of the source arrays is read (but not used) by the final prefetch
+ * @note This function executes in 6 + 6 * len CPU clock cycles (using compiler option -o2)
+ * @param src1  Pointer to complex array in Q0.15 format
+ * @param src2  Pointer to complex array in Q0.15 format
+ * @param dst   Pointer to complex multiplication result array in Q0.15 format
+ * @param len   Number of array elements
+ */
+inline static void cmulConj_aQ15(
+                                 const _CQ15 * src1,
+                                 const _CQ15 * src2,
+                                 _CQ15 * dst,
+                                 const uint16_t len)
+{
+    // Prefetched real and imaginary parts
+    _Q15 ar;
+    _Q15 ai;
+    _Q15 br;
+    _Q15 bi;
+
+    __asm__ volatile(
+            "\
+        clr     A, [%[src1]]+=2, %[ar], [%[src2]]+=2, %[br] ;Prefetch real parts of first elements \n \
+        clr     B, [%[src1]]+=2, %[ai], [%[src2]]+=2, %[bi] ;Prefetch imaginary parts of first elements \n \
+        do      %[len], cmulConj_aQ15_end_%=        ;Init Loop \n \
+        mpy     %[ar] * %[br], A                    ;ar * br in A \n \
+        mpy.n   %[ar] * %[bi], B, [%[src1]]+=2, %[ar] ;-ar * bi in B, prefetch next ar \n \
+        mac     %[ai] * %[br], B, [%[src2]]+=2, %[br] ;Add ai * br to B, prefetch next br \n \
+        mac     %[ai] * %[bi], A, [%[src1]]+=2, %[ai], [%[src2]]+=2, %[bi] ;Add ai * bi to A, prefetch next ai and bi \n \
+        sac.r   A, #0, [%[dst]++]                   ;Store real part \n \
+        cmulConj_aQ15_end_%=:                       ;\n \
+        sac.r   B, #0, [%[dst]++]                   ;Store imaginary part \n \
+        ; 4 + 6 * len cycles total, 1 DO level"
+            : [src1] "+x"(src1), [src2] "+y"(src2), [dst] "+r"(dst),
+              [ar] "=&z"(ar), [ai] "=&z"(ai), [br] "=&z"(br), [bi] "=&z"(bi) /*out*/
+            : [len] "r"(len - 1) /*in*/
+            : "memory" /*clobbered*/
+            );
+}
+
+/**
+ * @brief Complex multiply-accumulate of two complex arrays in Q0.15 format
+ *
+ * res = sum(src1[k] * src2[k])
+ *
+ * Real and imaginary part are accumulated in parallel in accA and accB, both source arrays are prefetched while accumulating.
+ * The accumulators provide 8 guard bits, so intermediate sums may exceed the range of Q0.15.
+ *
+ * @note The result is rounded according to CORCON.RND and saturated to Q0.15
+ * @note src1 must be located in X data memory, src2 must be located in Y data memory
+ * @note One element beyond the end of the source arrays is read (but not used) by the final prefetch
+ * @note This function executes in 8 + 4 * len CPU clock cycles (using compiler option -o2)
+ * @param src1  Pointer to complex array in Q0.15 format
+ * @param src2  Pointer to complex array in Q0.15 format
+ * @param len   Number of array elements
+ * @return      Accumulated result in Q0.15 format
+ */
+inline static _CQ15 cmac_aQ15(
+                             const _CQ15 * src1,
+                             const _CQ15 * src2,
+                             const uint16_t len)
+{
+    _CQ15 res;
+
+    // Prefetched real and imaginary parts
+    _Q15 ar;
+    _Q15 ai;
+    _Q15 br;
+    _Q15 bi;
+
+    __asm__ volatile(
+            "\
+        clr     A, [%[src1]]+=2, %[ar], [%[src2]]+=2, %[br] ;Prefetch real parts of first elements \n \
+        clr     B, [%[src1]]+=2, %[ai], [%[src2]]+=2, %[bi] ;Prefetch imaginary parts of first elements \n \
+        do      %[len], cmac_aQ15_end_%=            ;Init Loop \n \
+        mac     %[ar] * %[br], A                    ;Add ar * br to A \n \
+        mac     %[ar] * %[bi], B, [%[src1]]+=2, %[ar] ;Add ar * bi to B, prefetch next ar \n \
+        mac     %[ai] * %[br], B, [%[src2]]+=2, %[br] ;Add ai * br to B, prefetch next br \n \
+        cmac_aQ15_end_%=:                           ;\n \
+        msc     %[ai] * %[bi], A, [%[src1]]+=2, %[ai], [%[src2]]+=2, %[bi] ;Subtract ai * bi from A, prefetch next ai and bi \n \
+        sac.r   A, #0, %[re]                        ;Store real part \n \
+        sac.r   B, #0, %[im]                        ;Store imaginary part \n \
+        ; 6 + 4 * len cycles total, 1 DO level"
+            : [src1] "+x"(src1), [src2] "+y"(src2), [re] "=r"(res.re), [im] "=r"(res.im),
+              [ar] "=&z"(ar), [ai] "=&z"(ai), [br] "=&z"(br), [bi] "=&z"(bi) /*out*/
+            : [len] "r"(len - 1) /*in*/
+            : "memory" /*clobbered*/
+            );
+
+    return res;
+}
+
+/**
+ * @brief Complex multiply-accumulate of a complex array with the complex conjugate of another complex array in Q0.15 format
+ *
+ * res = sum(src1[k] * conj(src2[k]))
+ *
+ * Real and imaginary part are accumulated in parallel in accA and accB, both source arrays are prefetched while accumulating.
+ * The accumulators provide 8 guard bits, so intermediate sums may exceed the range of Q0.15.
+ *
+ * @note The result is rounded according to CORCON.RND and saturated to Q0.15
+ * @note src1 must be located in X data memory, src2 must be located in Y data memory
+ * @note One element beyond the end of the source arrays is read (but not used) by the final prefetch
+ * @note This function executes in 8 + 4 * len CPU clock cycles (using compiler option -o2)
+ * @param src1  Pointer to complex array in Q0.15 format
+ * @param src2  Pointer to complex array in Q0.15 format
+ * @param len   Number of array elements
+ * @return      Accumulated result in Q0.15 format
+ */
+inline static _CQ15 cmacConj_aQ15(
+                             const _CQ15 * src1,
+                             const _CQ15 * src2,
+                             const uint16_t len)
+{
+    _CQ15 res;
+
+    // Prefetched real and imaginary parts
+    _Q15 ar;
+    _Q15 ai;
+    _Q15 br;
+    _Q15 bi;
+
+    __asm__ volatile(
+            "\
+        clr     A, [%[src1]]+=2, %[ar], [%[src2]]+=2, %[br] ;Prefetch real parts of first elements \n \
+        clr     B, [%[src1]]+=2, %[ai], [%[src2]]+=2, %[bi] ;Prefetch imaginary parts of first elements \n \
+        do      %[len], cmacConj_aQ15_end_%=        ;Init Loop \n \
+        mac     %[ar] * %[br], A                    ;Add ar * br to A \n \
+        msc     %[ar] * %[bi], B, [%[src1]]+=2, %[ar] ;Subtract ar * bi from B, prefetch next ar \n \
+        mac     %[ai] * %[br], B, [%[src2]]+=2, %[br] ;Add ai * br to B, prefetch next br \n \
+        cmacConj_aQ15_end_%=:                       ;\n \
+        mac     %[ai] * %[bi], A, [%[src1]]+=2, %[ai], [%[src2]]+=2, %[bi] ;Add ai * bi to A, prefetch next ai and bi \n \
+        sac.r   A, #0, %[re]                        ;Store real part \n \
+        sac.r   B, #0, %[im]                        ;Store imaginary part \n \
+        ; 6 + 4 * len cycles total, 1 DO level"
+            : [src1] "+x"(src1), [src2] "+y"(src2), [re] "=r"(res.re), [im] "=r"(res.im),
+              [ar] "=&z"(ar), [ai] "=&z"(ai), [br] "=&z"(br), [bi] "=&z"(bi) /*out*/
+            : [len] "r"(len - 1) /*in*/
+            : "memory" /*clobbered*/
+            );
+
+    return res;
+}
+
+#endif
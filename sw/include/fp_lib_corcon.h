@@ -0,0 +1,193 @@
+/*
+Copyright (C) 2022 Andreas Lagler
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file fp_lib_corcon.h
+ * @brief DSP engine mode management (CORCON) and accumulator context save/restore
+ *
+ * The accumulator based routines of this library (e.g. interpLinear(), interpLUT_256_Q15()) expect the DSP engine
+ * in the mode given by CORCON_MODE_FP_LIB. Use corconSetMode()/corconRestore() or CORCON_SCOPE() to establish this mode
+ * around a kernel, and dspContextSave()/dspContextRestore() in interrupt service routines using the accumulators.
+ *
+ * This file is part of FP-Lib Fixed-point math library for dsPIC33 family of Microchip dsPIC digital signal controllers
+ */
+
+#ifndef FP_LIB_CORCON_H
+#define	FP_LIB_CORCON_H
+
+#include "fp_lib_types.h"
+
+#include <xc.h>
+#include <stdint.h>
+
+/*
+ *  CORCON bits controlling the DSP engine
+ */
+
+/// Unsigned multiplier mode (signed if cleared)
+#define CORCON_US       (1U << 12)
+
+/// Accumulator A saturation enable
+#define CORCON_SATA     (1U << 7)
+
+/// Accumulator B saturation enable
+#define CORCON_SATB     (1U << 6)
+
+/// Data space write saturation enable (sac/sac.r saturate to 16 bit)
+#define CORCON_SATDW    (1U << 5)
+
+/// Accumulator saturation mode select: 9.31 (super saturation) if set, 1.31 if cleared
+#define CORCON_ACCSAT   (1U << 4)
+
+/// Biased (conventional) rounding if set, unbiased (convergent) rounding if cleared
+#define CORCON_RND      (1U << 1)
+
+/// Integer multiplier mode (fractional if cleared)
+#define CORCON_IF       (1U << 0)
+
+/// All CORCON bits controlling the DSP engine
+#define CORCON_DSP_MASK (CORCON_US | CORCON_SATA | CORCON_SATB | CORCON_SATDW | CORCON_ACCSAT | CORCON_RND | CORCON_IF)
+
+/// DSP engine mode expected by this library: signed fractional multiply, convergent rounding, data space write saturation, no accumulator saturation
+#define CORCON_MODE_FP_LIB (CORCON_SATDW)
+
+/**
+ * @brief Execute the following statement or block with the DSP engine in a given mode
+ *
+ * The DSP engine mode bits of CORCON are saved before and restored after the statement.
+ * Leaving the statement by break, return or goto skips the restore.
+ *
+ * Example: CORCON_SCOPE(CORCON_MODE_FP_LIB) { y = interpLinear(y1, y2, x); }
+ *
+ * @param mode DSP engine mode given by a combination of CORCON_xxx bits
+ */
+#define CORCON_SCOPE(mode) \
+    for (uint16_t corconSaved_ = corconSetMode(mode), corconOnce_ = 1; corconOnce_; corconRestore(corconSaved_), corconOnce_ = 0)
+
+/**
+ * @brief Set the DSP engine mode
+ *
+ * Only the bits given by CORCON_DSP_MASK are modified, all other CORCON bits (e.g. IPL3, DO loop nesting) are preserved.
+ *
+ * @note This function executes in 5 CPU clock cycles (using compiler option -o2)
+ * @param mode DSP engine mode given by a combination of CORCON_xxx bits
+ * @return Previous content of CORCON, to be passed to corconRestore()
+ */
+inline static uint16_t corconSetMode(const uint16_t mode)
+{
+    const uint16_t saved = CORCON;
+    CORCON = (saved & ~CORCON_DSP_MASK) | (mode & CORCON_DSP_MASK);
+    return saved;
+}
+
+/**
+ * @brief Restore the DSP engine mode saved by corconSetMode()
+ *
+ * @note This function executes in 5 CPU clock cycles (using compiler option -o2)
+ * @param saved Content of CORCON returned by corconSetMode()
+ */
+inline static void corconRestore(const uint16_t saved)
+{
+    CORCON = (CORCON & ~CORCON_DSP_MASK) | (saved & CORCON_DSP_MASK);
+}
+
+/// DSP engine context, i.e. both accumulators and the DSP engine mode
+typedef struct
+{
+    /// Content of accA
+    Acc40 accA;
+
+    /// Content of accB
+    Acc40 accB;
+
+    /// Content of CORCON
+    uint16_t corcon;
+} DspContext;
+
+/**
+ * @brief Save the DSP engine context and set the DSP engine mode
+ *
+ * Call this function at the beginning of an interrupt service routine using the accumulators,
+ * if the interrupted code may use them as well.
+ *
+ * @note This function executes in 18 CPU clock cycles (using compiler option -o2)
+ * @param ctx   Pointer to DSP engine context
+ * @param mode  DSP engine mode given by a combination of CORCON_xxx bits
+ */
+inline static void dspContextSave(DspContext * const ctx, const uint16_t mode)
+{
+    // Write pointer for inline assembly
+    Acc40 * pAcc = &ctx->accA;
+
+    __asm__ volatile(
+            "\
+        mov     _ACCAL, w0                          ;Save accA \n \
+        mov     w0, [%[ctx]++]                      ; \n \
+        mov     _ACCAH, w0                          ; \n \
+        mov     w0, [%[ctx]++]                      ; \n \
+        mov     _ACCAU, w0                          ; \n \
+        mov     w0, [%[ctx]++]                      ; \n \
+        mov     _ACCBL, w0                          ;Save accB \n \
+        mov     w0, [%[ctx]++]                      ; \n \
+        mov     _ACCBH, w0                          ; \n \
+        mov     w0, [%[ctx]++]                      ; \n \
+        mov     _ACCBU, w0                          ; \n \
+        mov     w0, [%[ctx]]                        ; \n \
+        ;12 cycles total"
+            : [ctx] "+r"(pAcc) /*out*/
+            : /*in*/
+            : "w0", "memory" /*clobbered*/
+            );
+
+    ctx->corcon = corconSetMode(mode);
+}
+
+/**
+ * @brief Restore the DSP engine context saved by dspContextSave()
+ *
+ * @note This function executes in 18 CPU clock cycles (using compiler option -o2)
+ * @param ctx Pointer to DSP engine context
+ */
+inline static void dspContextRestore(const DspContext * const ctx)
+{
+    corconRestore(ctx->corcon);
+
+    // Read pointer for inline assembly
+    const Acc40 * pAcc = &ctx->accA;
+
+    __asm__ volatile(
+            "\
+        mov     [%[ctx]++], w0                      ;Restore accA \n \
+        mov     w0, _ACCAL                          ; \n \
+        mov     [%[ctx]++], w0                      ; \n \
+        mov     w0, _ACCAH                          ; \n \
+        mov     [%[ctx]++], w0                      ; \n \
+        mov     w0, _ACCAU                          ; \n \
+        mov     [%[ctx]++], w0                      ;Restore accB \n \
+        mov     w0, _ACCBL                          ; \n \
+        mov     [%[ctx]++], w0                      ; \n \
+        mov     w0, _ACCBH                          ; \n \
+        mov     [%[ctx]], w0                        ; \n \
+        mov     w0, _ACCBU                          ; \n \
+        ;12 cycles total"
+            : [ctx] "+r"(pAcc) /*out*/
+            : /*in*/
+            : "w0", "memory" /*clobbered*/
+            );
+}
+
+#endif
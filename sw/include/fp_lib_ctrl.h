@@ -0,0 +1,199 @@
+/*
+Copyright (C) 2022 Andreas Lagler
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file fp_lib_ctrl.h
+ * @brief Controller routines for fixed point types
+ *
+ * This file is part of FP-Lib Fixed-point math library for dsPIC33 family of Microchip dsPIC digital signal controllers
+ */
+
+#ifndef FP_LIB_CTRL_H
+#define	FP_LIB_CTRL_H
+
+#include "fp_lib_types.h"
+
+/**
+ * @brief PI controller state in Q0.15 format
+ *
+ * The integrator is kept with full 40-bit accumulator precision, so small integral gains do not lose the error increments to truncation.
+ * The proportional gain is kp * 2^kpShift, which allows for proportional gains >= 1.0.
+ * The output limits must satisfy outMin <= 0 <= outMax.
+ */
+typedef struct
+{
+    /// Proportional gain in Q0.15 format
+    _Q15 kp;
+
+    /// Left shift applied to the proportional term (0..15)
+    int16_t kpShift;
+
+    /// Integral gain per sample in Q0.15 format
+    _Q15 ki;
+
+    /// Anti-windup back-calculation gain in Q0.15 format
+    _Q15 kc;
+
+    /// Lower output limit in Q0.15 format
+    _Q15 outMin;
+
+    /// Upper output limit in Q0.15 format
+    _Q15 outMax;
+
+    /// Integrator state (image of accA)
+    Acc40 integ;
+} PI_Q15;
+
+/**
+ * @brief Preset the integrator of a PI controller
+ *
+ * Use this function for bumpless transfer, e.g. presetting the integrator with the current actuator value.
+ *
+ * @note This function executes in 3 CPU clock cycles (using compiler option -o2)
+ * @param pi    Pointer to PI controller state
+ * @param value Integrator value in Q0.15 format
+ */
+inline static void piReset_Q15(PI_Q15 * const pi, const _Q15 value)
+{
+    pi->integ.low = 0;
+    pi->integ.high = value;
+    pi->integ.upper = value >> 15;
+}
+
+/**
+ * @brief PI controller update with back-calculation anti-windup
+ *
+ * u = I + kp * 2^kpShift * e \n
+ * out = min(max(u, outMin), outMax) \n
+ * I = I + ki * e - kc * (u - out)
+ *
+ * The integrator is restored to accA, the proportional term is calculated in accB.
+ * The anti-windup excess out - u is calculated in accB from the unsaturated u, so it acts even if u exceeds the range of Q0.15
+ * or the limits do not include 0. The excess is saturated to Q0.15 when stored, the accumulators themselves are not saturated.
+ *
+ * @note The DSP engine must be in signed fractional mode with data space write saturation enabled (CORCON reset default)
+ * @note This function executes in 28 CPU clock cycles (using compiler option -o2)
+ * @param pi    Pointer to PI controller state
+ * @param e     Control error in Q0.15 format
+ * @return      Controller output in Q0.15 format, limited to [outMin, outMax]
+ */
+inline static _Q15 piUpdate_Q15(PI_Q15 * const pi, const _Q15 e)
+{
+    // Limited output
+    _Q15 out;
+
+    // Proportional gain, replaced by the anti-windup excess out - u in inline assembly
+    _Q15 kp = pi->kp;
+
+    __asm__ volatile(
+            "\
+        mov     [%[integ]], w0                      ;Restore integrator to A \n \
+        mov     w0, _ACCAL                          ; \n \
+        mov     [%[integ] + 2], w0                  ; \n \
+        mov     w0, _ACCAH                          ; \n \
+        mov     [%[integ] + 4], w0                  ; \n \
+        mov     w0, _ACCAU                          ; \n \
+        mpy     %[kp] * %[e], B                     ;Proportional term in B \n \
+        sftac   B, %[shift]                         ;Scale proportional term by 2^kpShift \n \
+        add     B                                   ;u = I + P in B \n \
+        sac.r   B, #0, %[out]                       ;out = saturated u \n \
+        cpslt   %[out], %[max]                      ;Compare out and outMax, skip if less \n \
+        mov     %[max], %[out]                      ;out = outMax \n \
+        cpsgt   %[out], %[min]                      ;Compare out and outMin, skip if greater \n \
+        mov     %[min], %[out]                      ;out = outMin \n \
+        neg     B                                   ;-u in B \n \
+        add     %[out], B                           ;Anti-windup excess out - u in B \n \
+        sac.r   B, #0, %[kp]                        ;Store saturated excess \n \
+        mac     %[ki] * %[e], A                     ;Add ki * e to integrator \n \
+        mac     %[kc] * %[kp], A                    ;Add kc * (out - u) to integrator \n \
+        mov     _ACCAL, w0                          ;Save integrator \n \
+        mov     w0, [%[integ]]                      ; \n \
+        mov     _ACCAH, w0                          ; \n \
+        mov     w0, [%[integ] + 2]                  ; \n \
+        mov     _ACCAU, w0                          ; \n \
+        mov     w0, [%[integ] + 4]                  ; \n \
+        ;25 cycles total"
+            : [out] "=&r"(out), [kp] "+z"(kp) /*out*/
+            : [e] "z"(e), [ki] "z"(pi->ki), [kc] "z"(pi->kc), [shift] "r"(-pi->kpShift),
+              [min] "r"(pi->outMin), [max] "r"(pi->outMax), [integ] "r"(&pi->integ) /*in*/
+            : "w0", "memory" /*clobbered*/
+            );
+
+    return out;
+}
+
+/**
+ * @brief PI controller update with clamping anti-windup
+ *
+ * I = min(max(I + ki * e, outMin), outMax) \n
+ * u = I + kp * 2^kpShift * e \n
+ * out = min(max(u, outMin), outMax)
+ *
+ * The integrator is restored to accA and reloaded with the limit if its saturated value reaches or exceeds the limit.
+ * The saturated value reaches the limit whenever accA does (also for limits at full scale), so accA cannot grow into the guard bits.
+ * The execution time does not depend on the controller state.
+ *
+ * @note The DSP engine must be in signed fractional mode with data space write saturation enabled (CORCON reset default)
+ * @note This function executes in 28 CPU clock cycles (using compiler option -o2)
+ * @param pi    Pointer to PI controller state
+ * @param e     Control error in Q0.15 format
+ * @return      Controller output in Q0.15 format, limited to [outMin, outMax]
+ */
+inline static _Q15 piUpdateClamp_Q15(PI_Q15 * const pi, const _Q15 e)
+{
+    // Limited output
+    _Q15 out;
+
+    __asm__ volatile(
+            "\
+        mov     [%[pInteg]], w0                     ;Restore integrator to A \n \
+        mov     w0, _ACCAL                          ; \n \
+        mov     [%[pInteg] + 2], w0                 ; \n \
+        mov     w0, _ACCAH                          ; \n \
+        mov     [%[pInteg] + 4], w0                 ; \n \
+        mov     w0, _ACCAU                          ; \n \
+        mac     %[ki] * %[e], A                     ;Add ki * e to integrator \n \
+        sac.r   A, #0, %[out]                       ;Store saturated integrator \n \
+        cpslt   %[out], %[max]                      ;Compare integrator and outMax, skip if less \n \
+        lac     %[max], #0, A                       ;Reload integrator with outMax \n \
+        cpsgt   %[out], %[min]                      ;Compare integrator and outMin, skip if greater \n \
+        lac     %[min], #0, A                       ;Reload integrator with outMin \n \
+        mpy     %[kp] * %[e], B                     ;Proportional term in B \n \
+        sftac   B, %[shift]                         ;Scale proportional term by 2^kpShift \n \
+        add     B                                   ;u = I + P in B \n \
+        sac.r   B, #0, %[out]                       ;Store saturated u \n \
+        cpslt   %[out], %[max]                      ;Compare out and outMax, skip if less \n \
+        mov     %[max], %[out]                      ;out = outMax \n \
+        cpsgt   %[out], %[min]                      ;Compare out and outMin, skip if greater \n \
+        mov     %[min], %[out]                      ;out = outMin \n \
+        mov     _ACCAL, w0                          ;Save integrator \n \
+        mov     w0, [%[pInteg]]                     ; \n \
+        mov     _ACCAH, w0                          ; \n \
+        mov     w0, [%[pInteg] + 2]                 ; \n \
+        mov     _ACCAU, w0                          ; \n \
+        mov     w0, [%[pInteg] + 4]                 ; \n \
+        ;26 cycles total"
+            : [out] "=&r"(out) /*out*/
+            : [e] "z"(e), [kp] "z"(pi->kp), [ki] "z"(pi->ki), [shift] "r"(-pi->kpShift),
+              [min] "r"(pi->outMin), [max] "r"(pi->outMax), [pInteg] "r"(&pi->integ) /*in*/
+            : "w0", "memory" /*clobbered*/
+            );
+
+    return out;
+}
+
+#endif
@@ -32,4 +32,22 @@ along with this program. If not, see <https://www.gnu.org/licenses/>.
 /// 0.5 in Q0.16 format
 #define Q16_HALF 32768U // corresponds to 0.5
 
+/// 1/sqrt(2) in Q0.16 format
+#define Q16_INV_SQRT2 46341U // corresponds to 0.70711
+
+/// 1 - 1/sqrt(2) in Q0.16 format
+#define Q16_ONE_MINUS_INV_SQRT2 19195U // corresponds to 0.29289
+
+/// pi/4 in Q0.16 format
+#define Q16_PI_QUARTER 51472U // corresponds to 0.78540
+
+/// log2(e) - 1 in Q0.16 format
+#define Q16_LOG2E_MINUS_1 29012U // corresponds to 0.44270
+
+/// 1/sqrt(3) in Q0.15 format
+#define Q15_INV_SQRT3 18919 // corresponds to 0.57735
+
+/// sqrt(3)/2 in Q0.15 format
+#define Q15_SQRT3_HALF 28378 // corresponds to 0.86603
+
 #endif
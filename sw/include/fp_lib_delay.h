@@ -0,0 +1,198 @@
+/*
+Copyright (C) 2022 Andreas Lagler
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file fp_lib_delay.h
+ * @brief Fractional delay line routines for fixed point types
+ *
+ * This file is part of FP-Lib Fixed-point math library for dsPIC33 family of Microchip dsPIC digital signal controllers
+ */
+
+#ifndef FP_LIB_DELAY_H
+#define	FP_LIB_DELAY_H
+
+#include "fp_lib_types.h"
+#include "fp_lib_interp.h"
+
+#include <stdint.h>
+
+/**
+ * @brief Delay line state in Q0.15 format
+ *
+ * The samples are stored in a circular buffer with a power-of-two length, so the read and write indices wrap around
+ * by a bit mask and all reads execute in a constant number of cycles.
+ * Delays are given in samples, delay 0 being the most recently written sample.
+ */
+typedef struct
+{
+    /// Pointer to circular buffer of mask + 1 samples
+    _Q15 * buffer;
+
+    /// Buffer length minus one (buffer length being a power of two)
+    uint16_t mask;
+
+    /// Index of the most recently written sample
+    uint16_t index;
+} Delay_Q15;
+
+/**
+ * @brief Initialize a delay line
+ *
+ * The buffer is cleared.
+ *
+ * @param dl        Pointer to delay line state
+ * @param buffer    Pointer to buffer of 2^log2Len samples
+ * @param log2Len   Base-2 logarithm of the buffer length (1 ... 15)
+ */
+inline static void delayInit_Q15(Delay_Q15 * const dl, _Q15 * const buffer, const uint16_t log2Len)
+{
+    dl->buffer = buffer;
+    dl->mask = (1U << log2Len) - 1;
+    dl->index = 0;
+
+    for (uint16_t i = 0; i <= dl->mask; ++i)
+    {
+        buffer[i] = 0;
+    }
+}
+
+/**
+ * @brief Write a sample to a delay line
+ * @param dl    Pointer to delay line state
+ * @param x     New sample in Q0.15 format
+ */
+inline static void delayWrite_Q15(Delay_Q15 * const dl, const _Q15 x)
+{
+    dl->index = (dl->index + 1) & dl->mask;
+    dl->buffer[dl->index] = x;
+}
+
+/**
+ * @brief Write a block of samples to a delay line
+ * @param dl    Pointer to delay line state
+ * @param src   Pointer to samples in Q0.15 format
+ * @param len   Number of samples
+ */
+inline static void delayWrite_aQ15(Delay_Q15 * const dl, const _Q15 * src, uint16_t len)
+{
+    while (len-- > 0)
+    {
+        delayWrite_Q15(dl, *src++);
+    }
+}
+
+/**
+ * @brief Read a delay line at an integer delay
+ * @param dl    Pointer to delay line state
+ * @param delay Delay in samples (0 ... buffer length - 1)
+ * @return      Delayed sample in Q0.15 format
+ */
+inline static _Q15 delayRead_Q15(const Delay_Q15 * const dl, const uint16_t delay)
+{
+    return dl->buffer[(dl->index - delay) & dl->mask];
+}
+
+/**
+ * @brief Read a delay line at a fractional delay using linear interpolation
+ *
+ * y = x[n - i] * (1 - f) + x[n - i - 1] * f with i and f being the integer and fractional part of the delay
+ *
+ * @note The DSP engine must be in the mode given by CORCON_MODE_FP_LIB (see fp_lib_corcon.h)
+ * @note This function executes in approx. 15 CPU clock cycles (using compiler option -o2)
+ * @param dl    Pointer to delay line state
+ * @param delay Delay in samples in Q16.16 format (0 ... buffer length - 2)
+ * @return      Delayed sample in Q0.15 format
+ */
+inline static _Q15 delayReadLinear_Q15(const Delay_Q15 * const dl, const _Q1616 delay)
+{
+    const uint16_t i = (dl->index - ((ULong) delay).high) & dl->mask;
+    return interpLinear(dl->buffer[i], dl->buffer[(i - 1) & dl->mask], ((ULong) delay).low);
+}
+
+/**
+ * @brief Read a delay line at a fractional delay using first-order allpass interpolation
+ *
+ * y = eta * x[n - i] + x[n - i - 1] - eta * y[n - 1] with eta = (1 - D) / (1 + D) \n
+ * with the delay split into an integer part i and a fractional part D in [0.5 ... 1.5[, so eta stays within [-1/5 ... 1/3].
+ *
+ * Unlike linear interpolation, allpass interpolation has a flat magnitude response, which is preferred in feedback loops (e.g. comb filters).
+ * Each tap needs its own state, and the delay should change slowly, since changes of eta cause transients.
+ *
+ * @note This function executes in approx. 50 CPU clock cycles (using compiler option -o2)
+ * @param dl    Pointer to delay line state
+ * @param delay Delay in samples in Q16.16 format (0.5 ... buffer length - 2)
+ * @param state Pointer to allpass state of the tap, i.e. the previous output y[n - 1] in Q0.15 format
+ * @return      Delayed sample in Q0.15 format
+ */
+inline static _Q15 delayReadAllpass_Q15(const Delay_Q15 * const dl, const _Q1616 delay, _Q15 * const state)
+{
+    // Split delay into integer part and fractional part D in [0.5 ... 1.5[
+    uint16_t i = ((ULong) delay).high;
+    int32_t D = ((ULong) delay).low;
+    if (D < 0x8000)
+    {
+        --i;
+        D += 0x10000;
+    }
+
+    // eta = (1 - D) / (1 + D) in Q0.15 format, numerator and denominator scaled by 1/8 to fit the 32/16 bit division
+    const _Q15 eta = __builtin_divsd(((0x10000 - D) << 15) >> 3, (0x10000 + D) >> 3);
+
+    const uint16_t k = (dl->index - i) & dl->mask;
+    const _Q15 x0 = dl->buffer[k];
+    const _Q15 x1 = dl->buffer[(k - 1) & dl->mask];
+
+    // y = x1 + eta * (x0 - y[n - 1]), rounded and saturated
+    int32_t y = (((int32_t) x1 << 15) + __builtin_mulss(eta, x0) - __builtin_mulss(eta, *state) + 0x4000) >> 15;
+    if (y > INT16_MAX)
+    {
+        y = INT16_MAX;
+    }
+    else if (y < INT16_MIN)
+    {
+        y = INT16_MIN;
+    }
+
+    *state = y;
+    return y;
+}
+
+/**
+ * @brief Read a delay line at multiple fractional delays using linear interpolation
+ *
+ * Same as delayReadLinear_Q15() for each tap, e.g. for multi-tap delays or modulated chorus voices.
+ *
+ * @note The DSP engine must be in the mode given by CORCON_MODE_FP_LIB (see fp_lib_corcon.h)
+ * @note This function executes in approx. 15 CPU clock cycles per tap (using compiler option -o2)
+ * @param dl        Pointer to delay line state
+ * @param delays    Pointer to delays in samples in Q16.16 format (0 ... buffer length - 2)
+ * @param dst       Pointer to delayed samples in Q0.15 format
+ * @param nTaps     Number of taps
+ */
+inline static void delayReadTaps_Q15(
+                                     const Delay_Q15 * const dl,
+                                     const _Q1616 * delays,
+                                     _Q15 * dst,
+                                     uint16_t nTaps)
+{
+    while (nTaps-- > 0)
+    {
+        *dst++ = delayReadLinear_Q15(dl, *delays++);
+    }
+}
+
+#endif
@@ -0,0 +1,313 @@
+/*
+Copyright (C) 2022 Andreas Lagler
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file fp_lib_env.h
+ * @brief Envelope generator routines for fixed point types
+ *
+ * This file is part of FP-Lib Fixed-point math library for dsPIC33 family of Microchip dsPIC digital signal controllers
+ */
+
+#ifndef FP_LIB_ENV_H
+#define	FP_LIB_ENV_H
+
+#include "fp_lib_types.h"
+#include "fp_lib_def.h"
+#include "fp_lib_exp.h"
+#include "fp_lib_mul.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/// Envelope level in Q0.15 format for an output gain in the range [0 ... 2[ (compile-time constants only)
+#define ENV_LEVEL(gain) ((_Q15) ((gain) * 16384.0 + 0.5))
+
+/// Attack target of envAdsrInit_Q15(), i.e. an output gain of 1.5. The attack segment ends at an output gain of 1.0
+#define ENV_ATTACK_TARGET ENV_LEVEL(1.5)
+
+/// Release end of envAdsrInit_Q15(), i.e. an output gain of 0.001 (-60 dB)
+#define ENV_RELEASE_END ENV_LEVEL(0.001)
+
+/**
+ * @brief Envelope segment in Q0.15 format
+ *
+ * The envelope level approaches the target exponentially: level = level + coef * 2^-shift * (target - level). \n
+ * The segment is complete when the level has crossed the end level in the direction of the target.
+ * Levels are given as half the output gain (see ENV_LEVEL()), so attack segments may aim at a target above full scale
+ * and end at full scale, which gives a finite attack time and a steeper approach to the peak.
+ */
+typedef struct
+{
+    /// Mantissa of the one-pole coefficient per sample in Q0.15 format
+    _Q15 coef;
+
+    /// Right shift of the one-pole coefficient (0..16)
+    int16_t shift;
+
+    /// Target level in Q0.15 format (half the output gain)
+    _Q15 target;
+
+    /// End level in Q0.15 format (half the output gain)
+    _Q15 end;
+} EnvSegment_Q15;
+
+/**
+ * @brief Multi-segment envelope generator state in Q0.15 format
+ *
+ * Segments 0 ... sustain are run after gate on, the sustain segment is held until gate off.
+ * Segments sustain + 1 ... count - 1 are run after gate off. The envelope is idle after the last segment.
+ * Several envelopes may share the same segment list.
+ */
+typedef struct
+{
+    /// Pointer to segment list
+    const EnvSegment_Q15 * seg;
+
+    /// Number of segments
+    uint16_t count;
+
+    /// Index of the sustain segment
+    uint16_t sustain;
+
+    /// Index of the current segment, count if idle
+    uint16_t index;
+
+    /// Envelope level in Q0.31 format (half the output gain)
+    _Q31 level;
+} Env_Q15;
+
+/**
+ * @brief Initialize an envelope segment
+ *
+ * coef * 2^-shift = 1 - exp(-rate) \n
+ * with rate = 2^log2Rate being the inverse time constant in samples, e.g. log2Rate = -log2_Q1516(tau * fs).
+ * Rates >= 1/16 are calculated as 1 - 2^(-rate * log2(e)) by exp2_Q1516() with shift = 0.
+ * Smaller rates are split into the mantissa 2^frac(log2Rate) and a shift given by the integer part, and corrected by the series
+ * 1 - exp(-rate) = rate * (1 - rate / 2 + rate^2 / 6 - ...), so long time constants retain the full precision of the mantissa.
+ *
+ * @note Rates below 2^-17 lose precision of the mantissa, since the shift is limited to 16
+ * @note This function executes in approx. 80 CPU clock cycles (using compiler option -o2)
+ * @param seg       Pointer to envelope segment
+ * @param log2Rate  Base-2 logarithm of the inverse time constant in samples in Q15.16 format
+ * @param target    Target level in Q0.15 format (half the output gain)
+ * @param end       End level in Q0.15 format (half the output gain)
+ */
+inline static void envSegmentInit_Q15(
+                                      EnvSegment_Q15 * const seg,
+                                      const _Q1516 log2Rate,
+                                      const _Q15 target,
+                                      const _Q15 end)
+{
+    seg->target = target;
+    seg->end = end;
+
+    if (log2Rate >= (4L << 16))
+    {
+        // Rates >= 16.0 are saturated
+        seg->coef = INT16_MAX;
+        seg->shift = 0;
+    }
+    else if (log2Rate >= (-4L << 16))
+    {
+        // rate * log2(e) in Q16.16 format
+        const _Q1616 rate = exp2_Q1516(log2Rate);
+        const _Q1616 k = rate + mul_Q1616_Q16(rate, Q16_LOG2E_MINUS_1);
+
+        // 1 - exp(-rate) in Q0.16 format, rounded to Q0.15
+        const uint32_t c = (65536UL - exp2_Q1516(-(_Q1516) k) + 1) >> 1;
+
+        seg->coef = (c > INT16_MAX) ? INT16_MAX : (_Q15) c;
+        seg->shift = 0;
+    }
+    else
+    {
+        // rate = 2^f / 2 * 2^-shift with 2^f in [1 ... 2[ in Q16.16 format
+        const _Q1616 m = exp2_Q1516(((Long) log2Rate).low);
+        int16_t shift = -((Long) log2Rate).high - 1;
+
+        // rate / 2 - rate^2 / 6 in Q0.16 format (rate < 1/16)
+        const _Q16 rate = (_Q16) (m >> (shift + 1));
+        const _Q16 corr = (rate >> 1) - __builtin_divud(__builtin_muluu(rate, rate) >> 16, 6);
+
+        // Mantissa 2^f / 2 * (1 - rate / 2 + rate^2 / 6) in Q0.15 format
+        _Q15 coef = (_Q15) (m >> 2);
+        coef -= (_Q15) (__builtin_muluu(coef, corr) >> 16);
+
+        if (shift > 16)
+        {
+            coef >>= (shift - 16);
+            shift = 16;
+        }
+
+        seg->coef = coef;
+        seg->shift = shift;
+    }
+}
+
+/**
+ * @brief Initialize an envelope generator
+ *
+ * The envelope is idle at level 0.
+ *
+ * @param env       Pointer to envelope state
+ * @param seg       Pointer to segment list
+ * @param count     Number of segments
+ * @param sustain   Index of the sustain segment
+ */
+inline static void envInit_Q15(
+                               Env_Q15 * const env,
+                               const EnvSegment_Q15 * const seg,
+                               const uint16_t count,
+                               const uint16_t sustain)
+{
+    env->seg = seg;
+    env->count = count;
+    env->sustain = sustain;
+    env->index = count;
+    env->level = 0;
+}
+
+/**
+ * @brief Set up the segment list of an ADSR envelope
+ *
+ * Attack aims at ENV_ATTACK_TARGET and ends at full scale, decay approaches the sustain level and is held as sustain segment,
+ * release approaches 0 and ends at ENV_RELEASE_END. Use envInit_Q15(env, seg, 3, 1) with the resulting segment list.
+ *
+ * @param seg       Pointer to a segment list of 3 segments
+ * @param attack    Base-2 logarithm of the attack rate in Q15.16 format (see envSegmentInit_Q15())
+ * @param decay     Base-2 logarithm of the decay rate in Q15.16 format (see envSegmentInit_Q15())
+ * @param sustain   Sustain gain in Q0.15 format
+ * @param release   Base-2 logarithm of the release rate in Q15.16 format (see envSegmentInit_Q15())
+ */
+inline static void envAdsrInit_Q15(
+                                   EnvSegment_Q15 * const seg,
+                                   const _Q1516 attack,
+                                   const _Q1516 decay,
+                                   const _Q15 sustain,
+                                   const _Q1516 release)
+{
+    envSegmentInit_Q15(&seg[0], attack, ENV_ATTACK_TARGET, ENV_LEVEL(1.0));
+    envSegmentInit_Q15(&seg[1], decay, sustain >> 1, sustain >> 1);
+    envSegmentInit_Q15(&seg[2], release, 0, ENV_RELEASE_END);
+}
+
+/**
+ * @brief Gate on, i.e. (re)start the envelope with the first segment from the current level
+ * @param env Pointer to envelope state
+ */
+inline static void envGateOn_Q15(Env_Q15 * const env)
+{
+    env->index = 0;
+}
+
+/**
+ * @brief Gate off, i.e. continue the envelope with the segment following the sustain segment
+ * @param env Pointer to envelope state
+ */
+inline static void envGateOff_Q15(Env_Q15 * const env)
+{
+    if (env->index <= env->sustain)
+    {
+        env->index = env->sustain + 1;
+    }
+}
+
+/**
+ * @brief Check if an envelope is idle
+ * @param env Pointer to envelope state
+ * @return true if the last segment is complete
+ */
+inline static bool envIsIdle_Q15(const Env_Q15 * const env)
+{
+    return env->index >= env->count;
+}
+
+/**
+ * @brief Generate a block of envelope gain in Q0.15 format
+ *
+ * The one-pole recurrence runs on accA within a DO loop, the shifted increment is calculated in accB:
+ * level = level + coef * 2^-shift * (target - level), gain = 2 * level (saturated). \n
+ * The level is restored to accA and saved in Q0.31 format, so long time constants do not stall due to truncation.
+ * Segment transitions are evaluated at the end of the block, i.e. segments are extended to the block boundary.
+ * Attack overshoot within the last block of the attack segment is clipped to full scale by data space write saturation.
+ *
+ * @note The DSP engine must be in the mode given by CORCON_MODE_FP_LIB (see fp_lib_corcon.h)
+ * @note This function executes in approx. 25 + 6 * len CPU clock cycles (using compiler option -o2)
+ * @param env   Pointer to envelope state
+ * @param dst   Pointer to gain array in Q0.15 format
+ * @param len   Number of array elements (> 0)
+ */
+inline static void env_aQ15(
+                            Env_Q15 * const env,
+                            _Q15 * dst,
+                            const uint16_t len)
+{
+    Long level = {.value = env->level};
+
+    if (env->index >= env->count)
+    {
+        // Idle envelope holds its level
+        const _Q15 gain = (level.high > INT16_MAX / 2) ? INT16_MAX : (level.high << 1);
+        uint16_t n;
+
+        for (n = 0; n < len; n++)
+        {
+            dst[n] = gain;
+        }
+
+        return;
+    }
+
+    const EnvSegment_Q15 * const seg = &env->seg[env->index];
+
+    // Difference target - level
+    _Q15 d;
+
+    __asm__ volatile(
+            "\
+        lac     %[yH], #0, A                        ;Restore envelope level to A \n \
+        mov     %[yL], _ACCAL                       ; \n \
+        do      %[len], env_aQ15_end_%=             ;Init loop over samples \n \
+        sub     %[t], %[yH], %[d]                   ;d = target - level \n \
+        mpy     %[c] * %[d], B                      ;Increment coef * d in B \n \
+        sftac   B, %[shift]                         ;Scale increment by 2^-shift \n \
+        add     A                                   ;level = level + increment \n \
+        sac.r   A, #-1, [%[dst]++]                  ;Store gain = 2 * level \n \
+        env_aQ15_end_%=:                            ;\n \
+        sac     A, #0, %[yH]                        ;Level for next sample \n \
+        mov     _ACCAL, %[yL]                       ;Save envelope level \n \
+        ; 4 + 6 * len cycles total, 1 DO level"
+            : [yH] "+r"(level.high), [yL] "+r"(level.low), [dst] "+r"(dst), [d] "=&z"(d) /*out*/
+            : [c] "z"(seg->coef), [shift] "r"(seg->shift), [t] "r"(seg->target), [len] "r"(len - 1) /*in*/
+            : "memory" /*clobbered*/
+            );
+
+    env->level = level.value;
+
+    // Advance to the next segment if the end level has been crossed
+    if (env->index != env->sustain)
+    {
+        const bool rising = seg->target >= seg->end;
+
+        if ((rising && level.high >= seg->end) || (!rising && level.high <= seg->end))
+        {
+            env->index++;
+        }
+    }
+}
+
+#endif
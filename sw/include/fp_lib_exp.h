@@ -0,0 +1,179 @@
+/*
+Copyright (C) 2022 Andreas Lagler
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file fp_lib_exp.h
+ * @brief Logarithm and exponential routines for fixed point types
+ *
+ * This file is part of FP-Lib Fixed-point math library for dsPIC33 family of Microchip dsPIC digital signal controllers
+ */
+
+#ifndef FP_LIB_EXP_H
+#define	FP_LIB_EXP_H
+
+#include "fp_lib_types.h"
+#include "fp_lib_interp.h"
+
+/**
+ * @brief Base-2 logarithm of a number in Q15.16 format
+ *
+ * The argument is normalized to x = 2^k * (1 + f) using ff1l, with f being the 16 bits below the leading one.
+ * log2(1 + f) is given by f plus a correction term log2(1 + f) - f, which is interpolated from a 256-point lookup-table
+ * (see interpLUT_256_Q15()). The correction term is stored with a scaling of 8 to retain precision.
+ *
+ * @note The absolute error is less than 3.2e-5 (2 LSB of Q15.16)
+ * @note Arguments <= 0 return the minimum value of Q15.16 (-32768.0)
+ * @note This function executes in 31 CPU clock cycles (using compiler option -o2)
+ * @param x Argument in Q15.16 format
+ * @return log2(x) in Q15.16 format, in the range [-16 ... 15[
+ */
+inline static _Q1516 log2_Q1516(const _Q1516 x)
+{
+    // Lookup-table of 8 * (log2(1 + f) - f) in Q0.15 format, f = 0 ... 1
+    static const _Q15 table[257] = {
+        0, 450, 895, 1334, 1768, 2195, 2618, 3034, 3446, 3851, 4252, 4647, 5037, 5421, 5801, 6175,
+        6544, 6908, 7267, 7620, 7969, 8313, 8652, 8986, 9315, 9639, 9959, 10273, 10583, 10889, 11189, 11485,
+        11777, 12064, 12346, 12624, 12897, 13166, 13431, 13691, 13947, 14198, 14446, 14689, 14927, 15162, 15392, 15619,
+        15841, 16059, 16273, 16483, 16688, 16890, 17088, 17282, 17472, 17659, 17841, 18020, 18194, 18365, 18532, 18696,
+        18856, 19012, 19164, 19313, 19458, 19599, 19737, 19871, 20002, 20129, 20253, 20373, 20490, 20604, 20714, 20820,
+        20924, 21024, 21120, 21213, 21303, 21390, 21474, 21554, 21631, 21705, 21775, 21843, 21907, 21968, 22026, 22081,
+        22133, 22182, 22228, 22271, 22311, 22348, 22381, 22412, 22440, 22465, 22488, 22507, 22523, 22537, 22548, 22556,
+        22561, 22563, 22562, 22559, 22553, 22545, 22533, 22519, 22502, 22483, 22460, 22436, 22408, 22378, 22346, 22310,
+        22272, 22232, 22189, 22144, 22096, 22045, 21992, 21936, 21878, 21818, 21755, 21690, 21622, 21552, 21479, 21404,
+        21327, 21247, 21165, 21081, 20994, 20905, 20814, 20720, 20624, 20526, 20426, 20323, 20218, 20111, 20001, 19890,
+        19776, 19660, 19542, 19422, 19299, 19175, 19048, 18919, 18788, 18655, 18520, 18382, 18243, 18102, 17958, 17813,
+        17665, 17516, 17364, 17210, 17055, 16897, 16738, 16576, 16413, 16247, 16080, 15911, 15739, 15566, 15391, 15214,
+        15035, 14854, 14672, 14487, 14301, 14113, 13923, 13731, 13537, 13342, 13144, 12945, 12744, 12541, 12337, 12131,
+        11923, 11713, 11501, 11288, 11073, 10856, 10638, 10417, 10196, 9972, 9747, 9520, 9291, 9061, 8829, 8595,
+        8360, 8123, 7884, 7644, 7402, 7159, 6914, 6667, 6419, 6169, 5918, 5665, 5411, 5154, 4897, 4638,
+        4377, 4115, 3851, 3585, 3319, 3050, 2780, 2509, 2236, 1962, 1686, 1409, 1130, 850, 568, 285,
+        0
+    };
+
+    if (x <= 0)
+    {
+        return INT32_MIN;
+    }
+
+    const uint16_t high = ((Long) x).high;
+    const uint16_t low = ((Long) x).low;
+
+    // Result
+    Long res;
+
+    // Fractional part f of mantissa in Q0.16 format
+    _Q16 f;
+
+    if (high != 0)
+    {
+        // Leading one in high word at bit position 0..15
+        const uint16_t pos = 16 - __builtin_ff1l(high);
+        res.high = pos;
+        f = (low >> pos) | ((high << (15 - pos)) << 1);
+    }
+    else
+    {
+        // Leading one in low word at bit position 0..15
+        const uint16_t pos = 16 - __builtin_ff1l(low);
+        res.high = pos - 16;
+        f = (low << (15 - pos)) << 1;
+    }
+
+    // Add log2(1 + f) = f + correction term
+    res.low = f;
+    res.value += (interpLUT_256_Q15(table, f) + 2) >> 2;
+
+    return res.value;
+}
+
+/**
+ * @brief Base-2 exponential of a number in Q15.16 format
+ *
+ * The argument is split into integer part n and fractional part f, 2^x = 2^n * (1 + m(f)).
+ * The mantissa m(f) = 2^f - 1 is given by f plus a correction term 2^f - 1 - f, which is interpolated from a 256-point lookup-table
+ * (see interpLUT_256_Q15()). The correction term is stored with a scaling of 8 to retain precision.
+ * Scaling by 2^n is done by multiplication with a power of two (mul.uu) instead of a 32 bit shift.
+ *
+ * @note The relative error is less than 1.2e-5 for x >= 0, the absolute error is less than 2 LSB of Q16.16 for x < 0
+ * @note Arguments >= 16.0 return the maximum value of Q16.16, arguments < -16.0 return 0
+ * @note This function executes in 27 CPU clock cycles (using compiler option -o2)
+ * @param x Argument in Q15.16 format
+ * @return 2^x in Q16.16 format
+ */
+inline static _Q1616 exp2_Q1516(const _Q1516 x)
+{
+    // Lookup-table of 8 * (2^f - 1 - f) in Q0.15 format, f = 0 ... 1
+    static const _Q15 table[257] = {
+        0, -313, -625, -934, -1241, -1547, -1851, -2152, -2452, -2749, -3045, -3339, -3631, -3921, -4208, -4494,
+        -4778, -5060, -5339, -5617, -5893, -6167, -6438, -6708, -6976, -7241, -7505, -7766, -8025, -8283, -8538, -8791,
+        -9042, -9291, -9538, -9782, -10025, -10266, -10504, -10740, -10974, -11206, -11436, -11664, -11889, -12112, -12334, -12553,
+        -12769, -12984, -13196, -13407, -13615, -13820, -14024, -14225, -14425, -14621, -14816, -15008, -15199, -15386, -15572, -15755,
+        -15936, -16115, -16292, -16466, -16638, -16807, -16975, -17140, -17302, -17462, -17620, -17776, -17929, -18080, -18229, -18375,
+        -18518, -18660, -18799, -18935, -19069, -19201, -19331, -19457, -19582, -19704, -19824, -19941, -20055, -20168, -20277, -20385,
+        -20489, -20592, -20691, -20789, -20883, -20976, -21065, -21153, -21237, -21319, -21399, -21476, -21550, -21622, -21691, -21758,
+        -21822, -21884, -21942, -21999, -22052, -22103, -22152, -22197, -22240, -22281, -22318, -22354, -22386, -22416, -22443, -22467,
+        -22488, -22507, -22523, -22537, -22547, -22555, -22561, -22563, -22563, -22559, -22553, -22545, -22533, -22519, -22502, -22482,
+        -22459, -22433, -22405, -22373, -22339, -22302, -22262, -22219, -22174, -22125, -22073, -22019, -21962, -21901, -21838, -21772,
+        -21703, -21631, -21555, -21477, -21396, -21312, -21225, -21135, -21042, -20946, -20847, -20745, -20639, -20531, -20420, -20305,
+        -20188, -20067, -19943, -19816, -19686, -19553, -19417, -19278, -19135, -18989, -18840, -18688, -18533, -18375, -18213, -18048,
+        -17880, -17709, -17534, -17356, -17175, -16991, -16803, -16612, -16418, -16221, -16020, -15816, -15608, -15398, -15183, -14966,
+        -14745, -14521, -14293, -14062, -13828, -13590, -13349, -13104, -12856, -12604, -12349, -12091, -11829, -11563, -11294, -11022,
+        -10746, -10466, -10183, -9897, -9606, -9313, -9016, -8715, -8410, -8102, -7790, -7475, -7156, -6834, -6508, -6178,
+        -5844, -5507, -5166, -4821, -4473, -4121, -3765, -3406, -3042, -2675, -2305, -1930, -1552, -1169, -783, -394,
+        0
+    };
+
+    // Exponent with offset 16, i.e. position of the leading one in the Q16.16 result
+    const int16_t exponent = ((Long) x).high + 16;
+
+    if (exponent < 0)
+    {
+        return 0;
+    }
+
+    if (exponent > 31)
+    {
+        return UINT32_MAX;
+    }
+
+    // Mantissa 2^f - 1 in Q0.16 format
+    const _Q16 f = ((Long) x).low;
+    const _Q16 m = f + ((interpLUT_256_Q15(table, f) + 2) >> 2);
+
+    // Result (1 + m) * 2^n in Q16.16 format
+    ULong res;
+
+    if (exponent < 16)
+    {
+        // Result < 1.0, only the fractional word is affected
+        const uint16_t scale = 1U << exponent;
+        res.value = __builtin_muluu(m, scale);
+        res.low = res.high + scale;
+        res.high = 0;
+    }
+    else
+    {
+        // Result >= 1.0
+        const uint16_t scale = 1U << (exponent - 16);
+        res.value = __builtin_muluu(m, scale);
+        res.high += scale;
+    }
+
+    return res.value;
+}
+
+#endif
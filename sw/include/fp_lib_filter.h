@@ -0,0 +1,447 @@
+/*
+Copyright (C) 2022 Andreas Lagler
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file fp_lib_filter.h
+ * @brief Filter routines for fixed point types
+ *
+ * This file is part of FP-Lib Fixed-point math library for dsPIC33 family of Microchip dsPIC digital signal controllers
+ */
+
+#ifndef FP_LIB_FILTER_H
+#define	FP_LIB_FILTER_H
+
+#include "fp_lib_types.h"
+#include "fp_lib_trig.h"
+
+#include <stdint.h>
+
+/**
+ * @brief Moving average filter state in Q0.15 format
+ *
+ * The average is calculated from a running sum, i.e. each update adds the new sample and subtracts the oldest one,
+ * so the execution time does not depend on the filter length. The running sum is exact, so no drift accumulates.
+ */
+typedef struct
+{
+    /// Pointer to delay line holding the last len samples in Q0.15 format
+    _Q15 * buffer;
+
+    /// Filter length (2 ... 65535)
+    uint16_t len;
+
+    /// Reciprocal of filter length in Q0.16 format, i.e. 65536 / len
+    _Q16 invLen;
+
+    /// Index of the oldest sample in the delay line
+    uint16_t index;
+
+    /// Running sum of the delay line in Q16.15 format
+    int32_t sum;
+} MovAvg_Q15;
+
+/**
+ * @brief Initialize a moving average filter
+ *
+ * The delay line is cleared.
+ *
+ * @param ma        Pointer to moving average filter state
+ * @param buffer    Pointer to delay line of len samples
+ * @param len       Filter length (2 ... 65535)
+ */
+inline static void movAvgInit_Q15(MovAvg_Q15 * const ma, _Q15 * const buffer, const uint16_t len)
+{
+    ma->buffer = buffer;
+    ma->len = len;
+    ma->invLen = (uint16_t) (65536UL / len);
+    ma->index = 0;
+    ma->sum = 0;
+
+    for (uint16_t i = 0; i < len; ++i)
+    {
+        buffer[i] = 0;
+    }
+}
+
+/**
+ * @brief Moving average of the current delay line in Q15.16 format
+ * @note The result is exact for filter lengths being a power of two
+ * @note This function executes in approx. 10 CPU clock cycles (using compiler option -o2)
+ * @param ma Pointer to moving average filter state
+ * @return Moving average in Q15.16 format
+ */
+inline static _Q1516 movAvgMean_Q1516(const MovAvg_Q15 * const ma)
+{
+    // sum * invLen in Q.31 format, shifted to Q15.16 format
+    const Long sum = {.value = ma->sum};
+    return (__builtin_mulsu(sum.high, ma->invLen) << 1) + (__builtin_muluu(sum.low, ma->invLen) >> 15);
+}
+
+/**
+ * @brief Moving average filter update in Q0.15 format
+ * @note This function executes in approx. 30 CPU clock cycles (using compiler option -o2)
+ * @param ma Pointer to moving average filter state
+ * @param x  New sample in Q0.15 format
+ * @return Moving average in Q0.15 format (rounded)
+ */
+inline static _Q15 movAvgUpdate_Q15(MovAvg_Q15 * const ma, const _Q15 x)
+{
+    ma->sum += (int32_t) x - ma->buffer[ma->index];
+    ma->buffer[ma->index] = x;
+    if (++ma->index == ma->len)
+    {
+        ma->index = 0;
+    }
+
+    return (movAvgMean_Q1516(ma) + 1) >> 1;
+}
+
+/**
+ * @brief Moving average filter update in Q15.16 format
+ * @note This function executes in approx. 30 CPU clock cycles (using compiler option -o2)
+ * @param ma Pointer to moving average filter state
+ * @param x  New sample in Q0.15 format
+ * @return Moving average in Q15.16 format
+ */
+inline static _Q1516 movAvgUpdate_Q1516(MovAvg_Q15 * const ma, const _Q15 x)
+{
+    ma->sum += (int32_t) x - ma->buffer[ma->index];
+    ma->buffer[ma->index] = x;
+    if (++ma->index == ma->len)
+    {
+        ma->index = 0;
+    }
+
+    return movAvgMean_Q1516(ma);
+}
+
+/**
+ * @brief Moving average filter of an array in Q0.15 format
+ * @param ma    Pointer to moving average filter state
+ * @param src   Pointer to input array in Q0.15 format
+ * @param dst   Pointer to output array in Q0.15 format
+ * @param len   Number of array elements
+ */
+inline static void movAvg_aQ15(
+                               MovAvg_Q15 * const ma,
+                               const _Q15 * src,
+                               _Q15 * dst,
+                               uint16_t len)
+{
+    while (len-- > 0)
+    {
+        *dst++ = movAvgUpdate_Q15(ma, *src++);
+    }
+}
+
+/// Maximum order of Cic_Q15
+#define CIC_MAX_ORDER 4
+
+/**
+ * @brief CIC decimation filter state in Q0.15 format
+ *
+ * A cascade of order integrators at the input rate, followed by order combs (differential delay 1) at the output rate.
+ * The integrators overflow by design: all stages use unsigned 32-bit two's complement arithmetic, and the combs cancel
+ * the wrap-arounds exactly as long as the output fits into 32 bits, i.e. order * log2Ratio <= 16.
+ * The decimation ratio is limited to 2^15 by the 16-bit sample counter.
+ *
+ * The DC gain is ratio^order = 2^(order * log2Ratio), which is removed by a rounded shift at the output.
+ */
+typedef struct
+{
+    /// Filter order (1 ... CIC_MAX_ORDER)
+    uint16_t order;
+
+    /// Base-2 logarithm of the decimation ratio (order * log2Ratio <= 16, log2Ratio <= 15)
+    uint16_t log2Ratio;
+
+    /// Number of input samples until the next output sample
+    uint16_t count;
+
+    /// Integrator states
+    uint32_t integ[CIC_MAX_ORDER];
+
+    /// Comb delay states
+    uint32_t comb[CIC_MAX_ORDER];
+} Cic_Q15;
+
+/**
+ * @brief Initialize a CIC decimation filter
+ * @param cic       Pointer to CIC filter state
+ * @param order     Filter order (1 ... CIC_MAX_ORDER)
+ * @param log2Ratio Base-2 logarithm of the decimation ratio (order * log2Ratio <= 16, log2Ratio <= 15)
+ */
+inline static void cicInit_Q15(Cic_Q15 * const cic, const uint16_t order, const uint16_t log2Ratio)
+{
+    cic->order = order;
+    cic->log2Ratio = log2Ratio;
+    cic->count = 1U << log2Ratio;
+
+    for (uint16_t i = 0; i < CIC_MAX_ORDER; ++i)
+    {
+        cic->integ[i] = 0;
+        cic->comb[i] = 0;
+    }
+}
+
+/**
+ * @brief CIC decimation filter update with full-precision output
+ *
+ * @note This function executes in approx. 5 + 4 * order CPU clock cycles per input sample
+ *       plus approx. 8 * order cycles per output sample (using compiler option -o2)
+ * @param cic   Pointer to CIC filter state
+ * @param x     New sample in Q0.15 format
+ * @param y     Pointer to output sample in Q(order * log2Ratio).15 format, i.e. scaled by ratio^order
+ * @return      1 if a new output sample is available, 0 otherwise
+ */
+inline static uint16_t cicUpdateRaw_Q15(Cic_Q15 * const cic, const _Q15 x, int32_t * const y)
+{
+    // Integrators with wrap-around
+    uint32_t acc = (uint32_t) (int32_t) x;
+    for (uint16_t i = 0; i < cic->order; ++i)
+    {
+        cic->integ[i] += acc;
+        acc = cic->integ[i];
+    }
+
+    if (--cic->count != 0)
+    {
+        return 0;
+    }
+    cic->count = 1U << cic->log2Ratio;
+
+    // Combs at output rate cancel the wrap-arounds
+    for (uint16_t i = 0; i < cic->order; ++i)
+    {
+        const uint32_t prev = cic->comb[i];
+        cic->comb[i] = acc;
+        acc -= prev;
+    }
+
+    *y = (int32_t) acc;
+    return 1;
+}
+
+/**
+ * @brief CIC decimation filter update with output in Q0.15 format
+ * @param cic   Pointer to CIC filter state
+ * @param x     New sample in Q0.15 format
+ * @param y     Pointer to output sample in Q0.15 format (rounded, saturated)
+ * @return      1 if a new output sample is available, 0 otherwise
+ */
+inline static uint16_t cicUpdate_Q15(Cic_Q15 * const cic, const _Q15 x, _Q15 * const y)
+{
+    int32_t raw;
+    if (!cicUpdateRaw_Q15(cic, x, &raw))
+    {
+        return 0;
+    }
+
+    const uint16_t shift = cic->order * cic->log2Ratio;
+    if (shift != 0)
+    {
+        raw = (raw + ((int32_t) 1 << (shift - 1))) >> shift;
+    }
+    *y = (raw > INT16_MAX) ? INT16_MAX : raw;
+    return 1;
+}
+
+/**
+ * @brief CIC decimation filter update with output in Q15.16 format
+ *
+ * The output retains one more fractional bit than cicUpdate_Q15(), the gain is 1.0
+ *
+ * @param cic   Pointer to CIC filter state
+ * @param x     New sample in Q0.15 format
+ * @param y     Pointer to output sample in Q15.16 format (rounded)
+ * @return      1 if a new output sample is available, 0 otherwise
+ */
+inline static uint16_t cicUpdate_Q1516(Cic_Q15 * const cic, const _Q15 x, _Q1516 * const y)
+{
+    int32_t raw;
+    if (!cicUpdateRaw_Q15(cic, x, &raw))
+    {
+        return 0;
+    }
+
+    const uint16_t shift = cic->order * cic->log2Ratio;
+    if (shift == 0)
+    {
+        *y = raw << 1;
+    }
+    else if (shift == 1)
+    {
+        *y = raw;
+    }
+    else
+    {
+        *y = (raw + ((int32_t) 1 << (shift - 2))) >> (shift - 1);
+    }
+    return 1;
+}
+
+/**
+ * @brief CIC decimation filter of an array in Q0.15 format
+ * @param cic   Pointer to CIC filter state
+ * @param src   Pointer to input array in Q0.15 format
+ * @param dst   Pointer to output array in Q0.15 format (at least len / ratio + 1 elements)
+ * @param len   Number of input array elements
+ * @return      Number of output samples written to dst
+ */
+inline static uint16_t cic_aQ15(
+                                Cic_Q15 * const cic,
+                                const _Q15 * src,
+                                _Q15 * dst,
+                                uint16_t len)
+{
+    uint16_t cnt = 0;
+    while (len-- > 0)
+    {
+        cnt += cicUpdate_Q15(cic, *src++, &dst[cnt]);
+    }
+    return cnt;
+}
+
+/// Maximum damping qHalf of Svf_Q15 in Q0.15 format (just below 0.75), which keeps the filter stable for all f < 1.0
+#define SVF_MAX_QHALF 24575
+
+/**
+ * @brief State-variable filter (Chamberlin topology) state in Q0.15 format
+ *
+ * lp = lp + f * bp \n
+ * hp = x - lp - q * bp \n
+ * bp = bp + f * hp \n
+ * with f = 2 * sin(pi * fc / fs) and q = 1 / Q.
+ *
+ * Lowpass, bandpass and highpass outputs are generated simultaneously. The cutoff coefficient f enters linearly,
+ * so it may change every sample without recalculating any other coefficient.
+ * lp and bp are kept in Q0.31 format, so low cutoff frequencies do not lose the increments to truncation.
+ *
+ * Stability limits in fixed point: \n
+ * - f must be less than 1.0 (Q0.15 format), i.e. fc < fs / 6. svfCoef_Q15() saturates f accordingly \n
+ * - The recurrence is stable for f^2 + 2 * f * q < 4. With f < 1.0 this holds for q < 1.5, i.e. qHalf < 0.75 (Q > 0.67).
+ *   svfInit_Q15() limits qHalf to SVF_MAX_QHALF accordingly \n
+ * - The bandpass gain at the cutoff frequency is approx. Q, so the input must be scaled by 1 / Q to avoid saturation
+ *   at high resonance. Saturated states limit the amplitude rather than wrapping around
+ */
+typedef struct
+{
+    /// Lowpass state in Q0.31 format
+    _Q31 lp;
+
+    /// Bandpass state in Q0.31 format
+    _Q31 bp;
+
+    /// Half of the damping q = 1 / Q in Q0.15 format, i.e. 1 / (2 * Q)
+    _Q15 qHalf;
+} Svf_Q15;
+
+/**
+ * @brief Initialize a state-variable filter
+ * @param svf   Pointer to filter state
+ * @param qHalf Half of the damping q = 1 / Q in Q0.15 format, i.e. 1 / (2 * Q), limited to [0 ... SVF_MAX_QHALF]
+ */
+inline static void svfInit_Q15(Svf_Q15 * const svf, const _Q15 qHalf)
+{
+    svf->lp = 0;
+    svf->bp = 0;
+    svf->qHalf = (qHalf > SVF_MAX_QHALF) ? SVF_MAX_QHALF : ((qHalf < 0) ? 0 : qHalf);
+}
+
+/**
+ * @brief Cutoff coefficient of a state-variable filter
+ *
+ * f = 2 * sin(pi * fc / fs) using sin_Q15(), saturated to the maximum of Q0.15 (fc >= fs / 6)
+ *
+ * @note This function executes in approx. 10 CPU clock cycles (using compiler option -o2)
+ * @param fc Normalized cutoff frequency fc / fs in Q0.15 format (0 ... 1/6)
+ * @return Cutoff coefficient f in Q0.15 format
+ */
+inline static _Q15 svfCoef_Q15(const _Q15 fc)
+{
+    const _Q15 s = sin_Q15(fc);
+    return (s >= 0x4000) ? INT16_MAX : (s << 1);
+}
+
+/**
+ * @brief State-variable filter of an array in Q0.15 format with per-sample cutoff modulation
+ *
+ * The lowpass state is restored to accA and the bandpass state to accB for each sample. The highpass output is calculated in accA
+ * in between, so all sums are saturated when stored rather than wrapped around.
+ *
+ * @note The DSP engine must be in the mode given by CORCON_MODE_FP_LIB (see fp_lib_corcon.h)
+ * @note This function executes in approx. 35 CPU clock cycles per sample (using compiler option -o2)
+ * @param svf   Pointer to filter state
+ * @param src   Pointer to input array in Q0.15 format
+ * @param fc    Pointer to normalized cutoff frequencies fc / fs in Q0.15 format (0 ... 1/6), one per sample
+ * @param lp    Pointer to lowpass output array in Q0.15 format
+ * @param bp    Pointer to bandpass output array in Q0.15 format
+ * @param hp    Pointer to highpass output array in Q0.15 format
+ * @param len   Number of array elements
+ */
+inline static void svf_aQ15(
+                            Svf_Q15 * const svf,
+                            const _Q15 * src,
+                            const _Q15 * fc,
+                            _Q15 * lp,
+                            _Q15 * bp,
+                            _Q15 * hp,
+                            uint16_t len)
+{
+    Long lpState = {.value = svf->lp};
+    Long bpState = {.value = svf->bp};
+    const _Q15 qHalf = svf->qHalf;
+
+    while (len-- > 0)
+    {
+        const _Q15 f = svfCoef_Q15(*fc++);
+        _Q15 hpOut;
+
+        __asm__ volatile(
+                "\
+            lac     %[lpH], #0, A                       ;Restore lowpass state to A \n \
+            mov     %[lpL], _ACCAL                      ; \n \
+            lac     %[bpH], #0, B                       ;Restore bandpass state to B \n \
+            mov     %[bpL], _ACCBL                      ; \n \
+            mac     %[f] * %[bpH], A                    ;lp = lp + f * bp \n \
+            sac     A, #0, %[lpH]                       ;Save lowpass state \n \
+            mov     _ACCAL, %[lpL]                      ; \n \
+            neg     A                                   ;hp = -lp \n \
+            add     %[x], A                             ;hp = x - lp \n \
+            msc     %[qHalf] * %[bpH], A                ;hp = x - lp - q * bp \n \
+            msc     %[qHalf] * %[bpH], A                ; \n \
+            sac.r   A, #0, %[hp]                        ;Store highpass output \n \
+            mac     %[f] * %[hp], B                     ;bp = bp + f * hp \n \
+            sac     B, #0, %[bpH]                       ;Save bandpass state \n \
+            mov     _ACCBL, %[bpL]                      ; \n \
+            ;15 cycles total"
+                : [lpH] "+r"(lpState.high), [lpL] "+r"(lpState.low), [bpH] "+z"(bpState.high), [bpL] "+r"(bpState.low),
+                  [hp] "=&z"(hpOut) /*out*/
+                : [x] "r"(*src++), [f] "z"(f), [qHalf] "z"(qHalf) /*in*/
+                : /*clobbered*/
+                );
+
+        *lp++ = lpState.high;
+        *bp++ = bpState.high;
+        *hp++ = hpOut;
+    }
+
+    svf->lp = lpState.value;
+    svf->bp = bpState.value;
+}
+
+#endif
@@ -0,0 +1,397 @@
+/*
+Copyright (C) 2022 Andreas Lagler
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file fp_lib_foc.h
+ * @brief Reference frame transformations for field-oriented control
+ *
+ * This file is part of FP-Lib Fixed-point math library for dsPIC33 family of Microchip dsPIC digital signal controllers
+ */
+
+#ifndef FP_LIB_FOC_H
+#define	FP_LIB_FOC_H
+
+#include "fp_lib_types.h"
+#include "fp_lib_def.h"
+#include "fp_lib_trig.h"
+
+/// Three-phase quantities (currents or voltages) in Q0.15 format
+typedef struct
+{
+    /// Phase a
+    _Q15 a;
+
+    /// Phase b
+    _Q15 b;
+
+    /// Phase c
+    _Q15 c;
+} ABC_Q15;
+
+/// Quantities in the stationary alpha/beta reference frame in Q0.15 format
+typedef struct
+{
+    /// alpha component
+    _Q15 alpha;
+
+    /// beta component
+    _Q15 beta;
+} AlphaBeta_Q15;
+
+/// Quantities in the rotating d/q reference frame in Q0.15 format
+typedef struct
+{
+    /// Direct component
+    _Q15 d;
+
+    /// Quadrature component
+    _Q15 q;
+} DQ_Q15;
+
+/// Three-phase duty cycles in Q0.16 format
+typedef struct
+{
+    /// Duty cycle of phase a
+    _Q16 a;
+
+    /// Duty cycle of phase b
+    _Q16 b;
+
+    /// Duty cycle of phase c
+    _Q16 c;
+} ABC_Q16;
+
+/**
+ * @brief Clarke transform of three-phase quantities in Q0.15 format
+ *
+ * alpha = a \n
+ * beta = (a + 2 * b) / sqrt(3) \n
+ * Phase c is not evaluated, a + b + c = 0 is assumed.
+ *
+ * @note beta is accumulated in accA and saturated to Q0.15 when stored
+ * @note This function executes in 6 CPU clock cycles (using compiler option -o2)
+ * @param abc   Pointer to three-phase quantities in Q0.15 format
+ * @param ab    Pointer to alpha/beta quantities in Q0.15 format
+ */
+inline static void clarke_Q15(const ABC_Q15 * const abc, AlphaBeta_Q15 * const ab)
+{
+    _Q15 beta;
+
+    // beta = a * 1/sqrt(3) + b * 1/sqrt(3) + b * 1/sqrt(3)
+    __asm__ volatile(
+            "\
+        mpy     %[a] * %[k], A                      ;a/sqrt(3) in A \n \
+        mac     %[b] * %[k], A                      ;Add b/sqrt(3) to A \n \
+        mac     %[b] * %[k], A                      ;Add b/sqrt(3) to A \n \
+        sac.r   A, #0, %[beta]                      ;Store A in beta \n \
+        ;4 cycles total"
+            : [beta] "=r"(beta) /*out*/
+            : [a] "z"(abc->a), [b] "z"(abc->b), [k] "z"(Q15_INV_SQRT3) /*in*/
+            : /*clobbered*/
+            );
+
+    ab->alpha = abc->a;
+    ab->beta = beta;
+}
+
+/**
+ * @brief Park transform of alpha/beta quantities in Q0.15 format with given sine and cosine of the rotor angle
+ *
+ * d = alpha * cos(theta) + beta * sin(theta) \n
+ * q = beta * cos(theta) - alpha * sin(theta)
+ *
+ * Use this function together with sincos_Q15() and invParkSinCos_Q15() to share one sine/cosine lookup per control cycle.
+ *
+ * @note d and q are calculated in accA and accB and saturated to Q0.15 when stored
+ * @note This function executes in 8 CPU clock cycles (using compiler option -o2)
+ * @param ab        Pointer to alpha/beta quantities in Q0.15 format
+ * @param sinTheta  Sine of rotor angle in Q0.15 format
+ * @param cosTheta  Cosine of rotor angle in Q0.15 format
+ * @param dq        Pointer to d/q quantities in Q0.15 format
+ */
+inline static void parkSinCos_Q15(
+                                  const AlphaBeta_Q15 * const ab,
+                                  const _Q15 sinTheta,
+                                  const _Q15 cosTheta,
+                                  DQ_Q15 * const dq)
+{
+    _Q15 d;
+    _Q15 q;
+
+    __asm__ volatile(
+            "\
+        mpy     %[alpha] * %[cos], A                ;alpha * cos in A \n \
+        mpy     %[beta] * %[cos], B                 ;beta * cos in B \n \
+        mac     %[beta] * %[sin], A                 ;Add beta * sin to A \n \
+        msc     %[alpha] * %[sin], B                ;Subtract alpha * sin from B \n \
+        sac.r   A, #0, %[d]                         ;Store A in d \n \
+        sac.r   B, #0, %[q]                         ;Store B in q \n \
+        ;6 cycles total"
+            : [d] "=r"(d), [q] "=r"(q) /*out*/
+            : [alpha] "z"(ab->alpha), [beta] "z"(ab->beta), [sin] "z"(sinTheta), [cos] "z"(cosTheta) /*in*/
+            : /*clobbered*/
+            );
+
+    dq->d = d;
+    dq->q = q;
+}
+
+/**
+ * @brief Park transform of alpha/beta quantities in Q0.15 format
+ *
+ * d = alpha * cos(theta) + beta * sin(theta) \n
+ * q = beta * cos(theta) - alpha * sin(theta) \n
+ * with theta in Q0.15 format mapping [-1 ... 1[ to [-pi ... pi[ (see sin_Q15())
+ *
+ * @note This function executes in 19 CPU clock cycles (using compiler option -o2)
+ * @param ab    Pointer to alpha/beta quantities in Q0.15 format
+ * @param theta Rotor angle in Q0.15 format
+ * @param dq    Pointer to d/q quantities in Q0.15 format
+ */
+inline static void park_Q15(
+                            const AlphaBeta_Q15 * const ab,
+                            const _Q15 theta,
+                            DQ_Q15 * const dq)
+{
+    _Q15 sinTheta;
+    _Q15 cosTheta;
+    sincos_Q15(theta, &sinTheta, &cosTheta);
+    parkSinCos_Q15(ab, sinTheta, cosTheta, dq);
+}
+
+/**
+ * @brief Inverse Park transform of d/q quantities in Q0.15 format with given sine and cosine of the rotor angle
+ *
+ * alpha = d * cos(theta) - q * sin(theta) \n
+ * beta = d * sin(theta) + q * cos(theta)
+ *
+ * @note alpha and beta are calculated in accA and accB and saturated to Q0.15 when stored
+ * @note This function executes in 8 CPU clock cycles (using compiler option -o2)
+ * @param dq        Pointer to d/q quantities in Q0.15 format
+ * @param sinTheta  Sine of rotor angle in Q0.15 format
+ * @param cosTheta  Cosine of rotor angle in Q0.15 format
+ * @param ab        Pointer to alpha/beta quantities in Q0.15 format
+ */
+inline static void invParkSinCos_Q15(
+                                     const DQ_Q15 * const dq,
+                                     const _Q15 sinTheta,
+                                     const _Q15 cosTheta,
+                                     AlphaBeta_Q15 * const ab)
+{
+    _Q15 alpha;
+    _Q15 beta;
+
+    __asm__ volatile(
+            "\
+        mpy     %[d] * %[cos], A                    ;d * cos in A \n \
+        mpy     %[d] * %[sin], B                    ;d * sin in B \n \
+        msc     %[q] * %[sin], A                    ;Subtract q * sin from A \n \
+        mac     %[q] * %[cos], B                    ;Add q * cos to B \n \
+        sac.r   A, #0, %[alpha]                     ;Store A in alpha \n \
+        sac.r   B, #0, %[beta]                      ;Store B in beta \n \
+        ;6 cycles total"
+            : [alpha] "=r"(alpha), [beta] "=r"(beta) /*out*/
+            : [d] "z"(dq->d), [q] "z"(dq->q), [sin] "z"(sinTheta), [cos] "z"(cosTheta) /*in*/
+            : /*clobbered*/
+            );
+
+    ab->alpha = alpha;
+    ab->beta = beta;
+}
+
+/**
+ * @brief Inverse Park transform of d/q quantities in Q0.15 format
+ *
+ * alpha = d * cos(theta) - q * sin(theta) \n
+ * beta = d * sin(theta) + q * cos(theta) \n
+ * with theta in Q0.15 format mapping [-1 ... 1[ to [-pi ... pi[ (see sin_Q15())
+ *
+ * @note This function executes in 19 CPU clock cycles (using compiler option -o2)
+ * @param dq    Pointer to d/q quantities in Q0.15 format
+ * @param theta Rotor angle in Q0.15 format
+ * @param ab    Pointer to alpha/beta quantities in Q0.15 format
+ */
+inline static void invPark_Q15(
+                               const DQ_Q15 * const dq,
+                               const _Q15 theta,
+                               AlphaBeta_Q15 * const ab)
+{
+    _Q15 sinTheta;
+    _Q15 cosTheta;
+    sincos_Q15(theta, &sinTheta, &cosTheta);
+    invParkSinCos_Q15(dq, sinTheta, cosTheta, ab);
+}
+
+/**
+ * @brief Inverse Clarke transform of alpha/beta quantities in Q0.15 format
+ *
+ * a = alpha \n
+ * b = -alpha / 2 + sqrt(3) / 2 * beta \n
+ * c = -alpha / 2 - sqrt(3) / 2 * beta
+ *
+ * @note b and c are calculated in accA and accB and saturated to Q0.15 when stored
+ * @note This function executes in 8 CPU clock cycles (using compiler option -o2)
+ * @param ab    Pointer to alpha/beta quantities in Q0.15 format
+ * @param abc   Pointer to three-phase quantities in Q0.15 format
+ */
+inline static void invClarke_Q15(const AlphaBeta_Q15 * const ab, ABC_Q15 * const abc)
+{
+    _Q15 b;
+    _Q15 c;
+
+    __asm__ volatile(
+            "\
+        mpy     %[alpha] * %[kh], A                 ;-alpha/2 in A \n \
+        mpy     %[alpha] * %[kh], B                 ;-alpha/2 in B \n \
+        mac     %[beta] * %[ks], A                  ;Add sqrt(3)/2 * beta to A \n \
+        msc     %[beta] * %[ks], B                  ;Subtract sqrt(3)/2 * beta from B \n \
+        sac.r   A, #0, %[b]                         ;Store A in b \n \
+        sac.r   B, #0, %[c]                         ;Store B in c \n \
+        ;6 cycles total"
+            : [b] "=r"(b), [c] "=r"(c) /*out*/
+            : [alpha] "z"(ab->alpha), [beta] "z"(ab->beta), [kh] "z"(-16384), [ks] "z"(Q15_SQRT3_HALF) /*in*/
+            : /*clobbered*/
+            );
+
+    abc->a = ab->alpha;
+    abc->b = b;
+    abc->c = c;
+}
+
+/**
+ * @brief Space-vector modulation using min-max injection
+ *
+ * The alpha/beta voltage reference is transformed to phase voltages v (see invClarke_Q15()),
+ * the common-mode offset (max(v) + min(v)) / 2 is subtracted and the result is mapped to duty cycles by
+ * duty = 0.5 + (v - offset) / 2 \n
+ * i.e. a phase voltage of +-1.0 in Q0.15 format corresponds to the full DC link voltage.
+ *
+ * The phase voltages are saturated to the Q0.15 range by invClarke_Q15(), so modulation is linear for |v_ref| < 1.0
+ * and the duty cycles never need to be clipped.
+ * Min/max are calculated with compare-and-skip instructions, so the execution time does not depend on the sector.
+ *
+ * @note This function executes in 31 CPU clock cycles (using compiler option -o2)
+ * @param ab    Pointer to alpha/beta voltage reference in Q0.15 format
+ * @param duty  Pointer to three-phase duty cycles in Q0.16 format
+ */
+inline static void svm_Q15(const AlphaBeta_Q15 * const ab, ABC_Q16 * const duty)
+{
+    // Phase voltages
+    ABC_Q15 v;
+    invClarke_Q15(ab, &v);
+
+    // Maximum and minimum phase voltage
+    _Q15 vMax;
+    _Q15 vMin;
+
+    __asm__ volatile(
+            "\
+        mov     %[a], %[max]                        ;max = a \n \
+        mov     %[a], %[min]                        ;min = a \n \
+        cpsgt   %[max], %[b]                        ;Compare max and b, skip if greater \n \
+        mov     %[b], %[max]                        ;max = b \n \
+        cpsgt   %[max], %[c]                        ;Compare max and c, skip if greater \n \
+        mov     %[c], %[max]                        ;max = c \n \
+        cpslt   %[min], %[b]                        ;Compare min and b, skip if less \n \
+        mov     %[b], %[min]                        ;min = b \n \
+        cpslt   %[min], %[c]                        ;Compare min and c, skip if less \n \
+        mov     %[c], %[min]                        ;min = c \n \
+        ;10 cycles total"
+            : [max] "=&r"(vMax), [min] "=&r"(vMin) /*out*/
+            : [a] "r"(v.a), [b] "r"(v.b), [c] "r"(v.c) /*in*/
+            : /*clobbered*/
+            );
+
+    // Common-mode offset, rounded towards +inf such that v - offset is in the range of Q0.15
+    const _Q15 offset = ((int32_t) vMax + vMin + 1) >> 1;
+
+    // duty = 0.5 + (v - offset) / 2, which is v - offset + 0x8000 in Q0.16
+    duty->a = (_Q16) (v.a - offset) + Q16_HALF;
+    duty->b = (_Q16) (v.b - offset) + Q16_HALF;
+    duty->c = (_Q16) (v.c - offset) + Q16_HALF;
+}
+
+/**
+ * @brief Conventional sector-based space-vector modulation
+ *
+ * The sector is determined from the ordering of the phase voltages v (see invClarke_Q15()).
+ * A sector lookup-table yields the phases carrying the maximum, middle and minimum voltage, and the duty cycles are calculated as \n
+ * duty_min = (1 - T1 - T2) / 2 \n
+ * duty_mid = duty_min + T2 \n
+ * duty_max = duty_min + T1 + T2 \n
+ * with the active vector times T1 = (v_max - v_mid) / 2 and T2 = (v_mid - v_min) / 2.
+ * The zero vectors are distributed symmetrically, so the result is identical to svm_Q15().
+ *
+ * The sector lookup replaces the usual if/else chain, so the execution time does not depend on the sector.
+ *
+ * @note This function executes in 35 CPU clock cycles (using compiler option -o2)
+ * @param ab    Pointer to alpha/beta voltage reference in Q0.15 format
+ * @param duty  Pointer to three-phase duty cycles in Q0.16 format
+ */
+inline static void svmSector_Q15(const AlphaBeta_Q15 * const ab, ABC_Q16 * const duty)
+{
+    // Indices of phases carrying maximum, middle and minimum voltage
+    // Sector code bit 0: a >= b, bit 1: b >= c, bit 2: c >= a
+    // Code 0 is impossible, code 7 means all phase voltages are equal
+    static const uint8_t sectorTable[8][3] = {
+        {0, 1, 2}, {0, 2, 1}, {1, 0, 2}, {0, 1, 2},
+        {2, 1, 0}, {2, 0, 1}, {1, 2, 0}, {0, 1, 2}
+    };
+
+    // Phase voltages
+    ABC_Q15 abc;
+    invClarke_Q15(ab, &abc);
+    const _Q15 v[3] = {abc.a, abc.b, abc.c};
+
+    // Sector code
+    uint16_t code;
+
+    __asm__ volatile(
+            "\
+        clr     %[code]                             ;Clear sector code \n \
+        cpslt   %[a], %[b]                          ;Compare a and b, skip if less \n \
+        bset    %[code], #0                         ;a >= b \n \
+        cpslt   %[b], %[c]                          ;Compare b and c, skip if less \n \
+        bset    %[code], #1                         ;b >= c \n \
+        cpslt   %[c], %[a]                          ;Compare c and a, skip if less \n \
+        bset    %[code], #2                         ;c >= a \n \
+        ;7 cycles total"
+            : [code] "=&r"(code) /*out*/
+            : [a] "r"(v[0]), [b] "r"(v[1]), [c] "r"(v[2]) /*in*/
+            : /*clobbered*/
+            );
+
+    const uint8_t * const sector = sectorTable[code];
+    const _Q15 vMax = v[sector[0]];
+    const _Q15 vMid = v[sector[1]];
+    const _Q15 vMin = v[sector[2]];
+
+    // Active vector times T1 + T2 and T2 in Q0.16, rounded as in svm_Q15()
+    const _Q16 t12 = (_Q16) vMax - (_Q16) vMin;
+    const _Q16 t2 = (_Q16) vMid - (_Q16) vMin;
+
+    _Q16 d[3];
+    d[sector[2]] = Q16_HALF - (t12 >> 1) - (t12 & 1);
+    d[sector[1]] = d[sector[2]] + t2;
+    d[sector[0]] = d[sector[2]] + t12;
+
+    duty->a = d[0];
+    duty->b = d[1];
+    duty->c = d[2];
+}
+
+#endif
@@ -35,6 +35,7 @@ along with this program. If not, see <https://www.gnu.org/licenses/>.
  * y(x) = y1 * (1 - x) + y2 * x = y1 - y1 * x + y2 * x \n
  * with x being a fractional x coordinate in the range [0 1[
  * 
+ * @note The DSP engine must be in the mode given by CORCON_MODE_FP_LIB (see fp_lib_corcon.h)
  * @note This function executes in 4 CPU clock cycles (using compiler option -o2)
  * @param y1    y coordinate of first sampling point
  * @param y2    y coordinate of second sampling point
@@ -76,6 +77,7 @@ inline static _Q15 interpLinear(
  * y_right(x) being the right-hand sampling point , in this case (256-point lookup-table) given by yTable(MSB(x)+1) \n
  * y(x) being the interpolation result such that y(0) = yTable[0] and y(1) = yTable[256]
  * 
+ * @note The DSP engine must be in the mode given by CORCON_MODE_FP_LIB (see fp_lib_corcon.h)
  * @note This function executes in 9 CPU clock cycles (using compiler option -o2)
  * @note The length of the lookup-table must be 256+1 = 257
  * @param yTable Pointer to a lookup-table holding 256+1 = 257 sampling points in Q0.15 format
@@ -115,4 +117,114 @@ inline static _Q15 interpLUT_256_Q15(
 
     return y;
 }
+
+/**
+ * @brief Two-channel linear interpolation between two frames of interleaved samples in Q0.15 format
+ * 
+ * y[c] = y1[c] * (1 - x) + y2[c] * x = y1[c] - y1[c] * x + y2[c] * x \n
+ * with c being the channel index 0..1 (e.g. left/right or I/Q), \n
+ * y1 and y2 being two consecutive frames of an interleaved buffer, i.e. frame[0] = y1[0], frame[1] = y1[1], frame[2] = y2[0], frame[3] = y2[1] \n
+ * x being a fractional x coordinate in the range [0 1[
+ * 
+ * Both channels are interpolated in parallel in accA and accB.
+ * 
+ * @note The DSP engine must be in the mode given by CORCON_MODE_FP_LIB (see fp_lib_corcon.h)
+ * @note frame must be located in X data memory
+ * @note This function executes in 12 CPU clock cycles (using compiler option -o2)
+ * @param frame Pointer to two consecutive frames of two interleaved channels in Q0.15 format
+ * @param x     fractional x coordinate of interpolation result in Q0.16 format
+ * @param y     Pointer to one frame of two interleaved channels holding the interpolation result in Q0.15 format
+ */
+inline static void interpLinear_2ch(
+                                    const _Q15 * const frame,
+                                    const _Q16 x,
+                                    _Q15 * const y)
+{
+    // Channel samples
+    _Q15 y0;
+    _Q15 y1;
+
+    // Dummy variable for read/write access to const parameter in inline assembly
+    const _Q15 * frameDummy;
+
+    // Use accA and accB to calculate the linear interpolation of both channels
+    // Y = Y1 * (1 - X) + Y2 * X = Y1 - Y1 * X + Y2 * X
+    __asm__ volatile(
+            "\
+        mov     [%[frame]++], %[y0]                 ;Load y1[0] \n \
+        mov     [%[frame]++], %[y1]                 ;Load y1[1] \n \
+        lac     %[y0], #0, A                        ;Load y1[0] in A \n \
+        lac     %[y1], #0, B                        ;Load y1[1] in B \n \
+        msc     %[y0] * %[x], A, [%[frame]]+=2, %[y0] ;Subtract y1[0] * x from A, prefetch y2[0] \n \
+        msc     %[y1] * %[x], B, [%[frame]], %[y1]  ;Subtract y1[1] * x from B, prefetch y2[1] \n \
+        mac     %[y0] * %[x], A                     ;Add y2[0] * x to A \n \
+        mac     %[y1] * %[x], B                     ;Add y2[1] * x to B \n \
+        sac.r   A, #0, %[y0]                        ;Store A in y[0] \n \
+        sac.r   B, #0, %[y1]                        ;Store B in y[1] \n \
+        ;10 cycles total"
+            : [y0] "=&z"(y0), [y1] "=&z"(y1), [frame] "=x"(frameDummy) /*out*/
+            : "[frame]"(frame), [x] "z"(x >> 1) /*in*/
+            : "memory" /*clobbered*/
+            );
+
+    y[0] = y0;
+    y[1] = y1;
+}
+
+/**
+ * @brief Two-channel linear interpolation of a 256-point lookup-table of interleaved samples in Q0.15 format
+ * 
+ * Same as interpLUT_256_Q15(), but for a lookup-table holding two interleaved channels (e.g. left/right or I/Q), \n
+ * i.e. yTable[2 * i] is the sampling point i of channel 0 and yTable[2 * i + 1] is the sampling point i of channel 1.
+ * 
+ * Both channels are interpolated in parallel in accA and accB.
+ * 
+ * @note The DSP engine must be in the mode given by CORCON_MODE_FP_LIB (see fp_lib_corcon.h)
+ * @note This function executes in 16 CPU clock cycles (using compiler option -o2)
+ * @note The length of the lookup-table must be 2 * (256+1) = 514
+ * @param yTable Pointer to a lookup-table holding 2 * (256+1) = 514 interleaved sampling points in Q0.15 format
+ * @param x     fractional x coordinate of interpolation result in Q0.16 format
+ * @param y     Pointer to one frame of two interleaved channels holding the interpolation result in Q0.15 format
+ */
+inline static void interpLUT_256_Q15_2ch(
+                                                  const _Q15 * const yTable,
+                                                  const _Q16 x,
+                                                  _Q15 * const y)
+{
+    // Channel samples
+    _Q15 y0;
+    _Q15 y1;
+
+    // Dummy variables for read/write access to const parameters in inline assembly
+    const _Q15 * yTableDummy;
+    _Q16 xDummy;
+
+    // Use accA and accB to calculate the linear interpolation of both channels
+    // y = y_left * (1 - x_frac) + y_right * x_frac = y_left - y_left * x_frac + y_right * x_frac
+    __asm__ volatile(
+            "\
+        lsr     %[x], #0x8, %[y0]                   ;Mask MSB of X --> table index 0..255 \n \
+        sl      %[y0], #2, %[y0]                    ;Quadruple the table index for access of interleaved 16 bit frames \n \
+        add     %[yTable], %[y0], %[yTable]         ;yTable points to y_left[0] now \n \
+        and     #0xff, %[x]                         ;Mask fractional part of X \n \
+        movsac  A, [%[yTable]]+=2, %[y0]            ;Prefetch y_left[0] \n \
+        movsac  B, [%[yTable]]+=2, %[y1]            ;Prefetch y_left[1] \n \
+        lac     %[y0], #7, A                        ;Load prescaled y_left[0] in A \n \
+        lac     %[y1], #7, B                        ;Load prescaled y_left[1] in B \n \
+        msc     %[y0] * %[x], A, [%[yTable]]+=2, %[y0] ;Subtract y_left[0] * x_frac from A, prefetch y_right[0] \n \
+        msc     %[y1] * %[x], B, [%[yTable]], %[y1] ;Subtract y_left[1] * x_frac from B, prefetch y_right[1] \n \
+        mac     %[y0] * %[x], A                     ;Add y_right[0] * x_frac to A \n \
+        mac     %[y1] * %[x], B                     ;Add y_right[1] * x_frac to B \n \
+        sac.r   A, #-7, %[y0]                       ;Store scaled A in y[0] \n \
+        sac.r   B, #-7, %[y1]                       ;Store scaled B in y[1] \n \
+        ;14 cycles total"
+            : [y0] "=&z"(y0), [y1] "=&z"(y1), [yTable] "=x"(yTableDummy), [x] "=z"(xDummy) /*out*/
+            : "[yTable]"(yTable), "[x]"(x) /*in*/
+            : "memory" /*clobbered*/
+            );
+
+    y[0] = y0;
+    y[1] = y1;
+}
+
 #endif
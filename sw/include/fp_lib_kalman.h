@@ -0,0 +1,384 @@
+/*
+Copyright (C) 2022 Andreas Lagler
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file fp_lib_kalman.h
+ * @brief Kalman filter for low-order state estimation
+ *
+ * This file is part of FP-Lib Fixed-point math library for dsPIC33 family of Microchip dsPIC digital signal controllers
+ */
+
+#ifndef FP_LIB_KALMAN_H
+#define	FP_LIB_KALMAN_H
+
+#include "fp_lib_types.h"
+#include "fp_lib_add.h"
+#include "fp_lib_mul.h"
+
+#include <stdint.h>
+
+/// Maximum number of states of Kalman_Q15
+#define KALMAN_MAX_STATES 4
+
+/**
+ * @brief Kalman filter with up to KALMAN_MAX_STATES states and a scalar measurement
+ *
+ * Model: \n
+ * x[k+1] = F * x[k] + w, cov(w) = Q \n
+ * z[k] = H * x[k] + v, var(v) = R
+ *
+ * Scaling rules: \n
+ * - The states are scaled such that all states and their covariances stay within [-1, 1[ (Q0.15 and Q0.31 format) \n
+ * - The state transition matrix is stored as D = F - I, so transition matrices close to identity (e.g. position/speed integration
+ *   with a small time step) are represented without loss. The elements of D must be within [-1, 1[ \n
+ * - The Kalman gain is saturated to [-1, 1[, i.e. the measurement must be scaled such that |P * H^T| < H * P * H^T + R \n
+ * - All sums are saturated, so an ill-scaled filter saturates rather than wraps around
+ *
+ * Only the upper triangle of P is calculated, the lower triangle is mirrored to keep P exactly symmetric.
+ */
+typedef struct
+{
+    /// Number of states (1 ... KALMAN_MAX_STATES)
+    uint16_t n;
+
+    /// State estimate in Q0.15 format
+    _Q15 x[KALMAN_MAX_STATES];
+
+    /// Error covariance in Q0.31 format
+    _Q31 P[KALMAN_MAX_STATES][KALMAN_MAX_STATES];
+
+    /// State transition matrix minus identity (F - I) in Q0.15 format
+    _Q15 D[KALMAN_MAX_STATES][KALMAN_MAX_STATES];
+
+    /// Process noise covariance in Q0.31 format
+    _Q31 Q[KALMAN_MAX_STATES][KALMAN_MAX_STATES];
+
+    /// Measurement vector in Q0.15 format
+    _Q15 H[KALMAN_MAX_STATES];
+
+    /// Measurement noise variance in Q0.31 format
+    _Q31 R;
+} Kalman_Q15;
+
+/**
+ * @brief Reset state estimate and error covariance of a Kalman filter
+ *
+ * The model (n, D, Q, H, R) is not modified.
+ *
+ * @param kf    Pointer to Kalman filter
+ * @param x0    Pointer to initial state estimate in Q0.15 format (n elements)
+ * @param p0    Initial variance of all states in Q0.31 format, P = p0 * I
+ */
+inline static void kalmanReset_Q15(Kalman_Q15 * const kf, const _Q15 * const x0, const _Q31 p0)
+{
+    for (uint16_t i = 0; i < kf->n; ++i)
+    {
+        kf->x[i] = x0[i];
+        for (uint16_t j = 0; j < kf->n; ++j)
+        {
+            kf->P[i][j] = (i == j) ? p0 : 0;
+        }
+    }
+}
+
+/**
+ * @brief Saturated sum of a number and a dot product in Q0.15 format
+ *
+ * res = init + a * b \n
+ * The sum is accumulated in accA and saturated to Q0.15 when stored.
+ *
+ * @note The DSP engine must be in the mode given by CORCON_MODE_FP_LIB (see fp_lib_corcon.h)
+ * @note This function executes in 6 + 3 * n CPU clock cycles (using compiler option -o2)
+ * @param init  Initial value in Q0.15 format
+ * @param a     Pointer to first vector in Q0.15 format
+ * @param b     Pointer to second vector in Q0.15 format
+ * @param n     Number of vector elements (> 0)
+ * @return      Rounded and saturated sum in Q0.15 format
+ */
+inline static _Q15 kalmanMac_Q15(const _Q15 init, const _Q15 * a, const _Q15 * b, const uint16_t n)
+{
+    _Q15 res;
+    _Q15 va;
+    _Q15 vb;
+
+    __asm__ volatile(
+            "\
+        lac     %[init], #0, A                      ;Load initial value to A \n \
+        do      %[n], kalmanMac_Q15_end_%=          ;Init Loop \n \
+        mov     [%[a]++], %[va]                     ;Load vector elements \n \
+        mov     [%[b]++], %[vb]                     ; \n \
+        kalmanMac_Q15_end_%=:                       ;\n \
+        mac     %[va] * %[vb], A                    ;Add product to A \n \
+        sac.r   A, #0, %[res]                       ;Store saturated sum \n \
+        ; 4 + 3 * n cycles total, 1 DO level"
+            : [res] "=&r"(res), [a] "+r"(a), [b] "+r"(b), [va] "=&z"(va), [vb] "=&z"(vb) /*out*/
+            : [init] "r"(init), [n] "r"(n - 1) /*in*/
+            : "memory" /*clobbered*/
+            );
+
+    return res;
+}
+
+/**
+ * @brief Saturated difference of a number and a dot product in Q0.15 format
+ *
+ * res = init - a * b \n
+ * The difference is accumulated in accA and saturated to Q0.15 when stored.
+ *
+ * @note The DSP engine must be in the mode given by CORCON_MODE_FP_LIB (see fp_lib_corcon.h)
+ * @note This function executes in 6 + 3 * n CPU clock cycles (using compiler option -o2)
+ * @param init  Initial value in Q0.15 format
+ * @param a     Pointer to first vector in Q0.15 format
+ * @param b     Pointer to second vector in Q0.15 format
+ * @param n     Number of vector elements (> 0)
+ * @return      Rounded and saturated difference in Q0.15 format
+ */
+inline static _Q15 kalmanMsc_Q15(const _Q15 init, const _Q15 * a, const _Q15 * b, const uint16_t n)
+{
+    _Q15 res;
+    _Q15 va;
+    _Q15 vb;
+
+    __asm__ volatile(
+            "\
+        lac     %[init], #0, A                      ;Load initial value to A \n \
+        do      %[n], kalmanMsc_Q15_end_%=          ;Init Loop \n \
+        mov     [%[a]++], %[va]                     ;Load vector elements \n \
+        mov     [%[b]++], %[vb]                     ; \n \
+        kalmanMsc_Q15_end_%=:                       ;\n \
+        msc     %[va] * %[vb], A                    ;Subtract product from A \n \
+        sac.r   A, #0, %[res]                       ;Store saturated difference \n \
+        ; 4 + 3 * n cycles total, 1 DO level"
+            : [res] "=&r"(res), [a] "+r"(a), [b] "+r"(b), [va] "=&z"(va), [vb] "=&z"(vb) /*out*/
+            : [init] "r"(init), [n] "r"(n - 1) /*in*/
+            : "memory" /*clobbered*/
+            );
+
+    return res;
+}
+
+/**
+ * @brief Saturated sum of a number and a product in Q0.15 format
+ *
+ * res = init + a * b \n
+ * The sum is calculated in accA and saturated to Q0.15 when stored.
+ *
+ * @note The DSP engine must be in the mode given by CORCON_MODE_FP_LIB (see fp_lib_corcon.h)
+ * @note This function executes in 4 CPU clock cycles (using compiler option -o2)
+ * @param init  Initial value in Q0.15 format
+ * @param a     First factor in Q0.15 format
+ * @param b     Second factor in Q0.15 format
+ * @return      Rounded and saturated sum in Q0.15 format
+ */
+inline static _Q15 kalmanMacScalar_Q15(const _Q15 init, const _Q15 a, const _Q15 b)
+{
+    _Q15 res;
+
+    __asm__ volatile(
+            "\
+        lac     %[init], #0, A                      ;Load initial value to A \n \
+        mac     %[a] * %[b], A                      ;Add product to A \n \
+        sac.r   A, #0, %[res]                       ;Store saturated sum \n \
+        ;3 cycles total"
+            : [res] "=r"(res) /*out*/
+            : [init] "r"(init), [a] "z"(a), [b] "z"(b) /*in*/
+            : /*clobbered*/
+            );
+
+    return res;
+}
+
+/**
+ * @brief Kalman gain element num / den in Q0.15 format
+ *
+ * den is normalized to 15 bits using ff1l, so the quotient is calculated by a single 32/16 bit division.
+ *
+ * @param num   Element of P * H^T in Q0.31 format
+ * @param den   Innovation variance H * P * H^T + R in Q0.31 format (> 0)
+ * @return      num / den in Q0.15 format, saturated if |num| >= den
+ */
+inline static _Q15 kalmanGain_Q15(const _Q31 num, const _Q31 den)
+{
+    if (num >= den)
+    {
+        return INT16_MAX;
+    }
+    if (num <= -den)
+    {
+        return -INT16_MAX;
+    }
+
+    // Position of the leading one of den (0 ... 30)
+    const uint16_t high = ((Long) den).high;
+    const int16_t msb = (high != 0) ? (32 - __builtin_ff1l(high)) : (16 - __builtin_ff1l(((Long) den).low));
+
+    // Normalize den to [2^14, 2^15[ and scale num by the same factor times 2^15.
+    // |num| < den guarantees |num| * 2^(29 - msb) < 2^30
+    const int16_t shift = 29 - msb;
+    int16_t den16;
+    int32_t num32;
+    if (shift >= 15)
+    {
+        den16 = den << (shift - 15);
+        num32 = num << shift;
+    }
+    else if (shift >= 0)
+    {
+        den16 = den >> (15 - shift);
+        num32 = num << shift;
+    }
+    else
+    {
+        den16 = den >> 16;
+        num32 = num >> 1;
+    }
+
+    // Saturate if the truncation of den16 pushes the quotient out of range
+    const int32_t lim = (int32_t) den16 << 15;
+    if (num32 >= lim)
+    {
+        return INT16_MAX;
+    }
+    if (num32 <= -lim)
+    {
+        return -INT16_MAX;
+    }
+
+    return __builtin_divsd(num32, den16);
+}
+
+/**
+ * @brief Kalman filter prediction step
+ *
+ * x = F * x = x + D * x \n
+ * P = F * P * F^T + Q = T + T * D^T + Q with T = P + D * P
+ *
+ * @note The DSP engine must be in the mode given by CORCON_MODE_FP_LIB (see fp_lib_corcon.h)
+ * @note This function executes in approx. 110 (n = 1), 490 (n = 2), 1390 (n = 3) or 3040 (n = 4) CPU clock cycles (using compiler option -o2)
+ * @param kf Pointer to Kalman filter
+ */
+inline static void kalmanPredict_Q15(Kalman_Q15 * const kf)
+{
+    const uint16_t n = kf->n;
+
+    // State prediction x = x + D * x
+    _Q15 x[KALMAN_MAX_STATES];
+    for (uint16_t i = 0; i < n; ++i)
+    {
+        x[i] = kalmanMac_Q15(kf->x[i], kf->D[i], kf->x, n);
+    }
+    for (uint16_t i = 0; i < n; ++i)
+    {
+        kf->x[i] = x[i];
+    }
+
+    // T = P + D * P
+    _Q31 T[KALMAN_MAX_STATES][KALMAN_MAX_STATES];
+    for (uint16_t i = 0; i < n; ++i)
+    {
+        for (uint16_t j = 0; j < n; ++j)
+        {
+            _Q31 acc = kf->P[i][j];
+            for (uint16_t k = 0; k < n; ++k)
+            {
+                acc = add_Q31_Sat(acc, mul_Q31_Q15(kf->P[k][j], kf->D[i][k]));
+            }
+            T[i][j] = acc;
+        }
+    }
+
+    // P = T + T * D^T + Q, upper triangle mirrored to lower triangle
+    for (uint16_t i = 0; i < n; ++i)
+    {
+        for (uint16_t j = i; j < n; ++j)
+        {
+            _Q31 acc = add_Q31_Sat(T[i][j], kf->Q[i][j]);
+            for (uint16_t k = 0; k < n; ++k)
+            {
+                acc = add_Q31_Sat(acc, mul_Q31_Q15(T[i][k], kf->D[j][k]));
+            }
+            kf->P[i][j] = acc;
+            kf->P[j][i] = acc;
+        }
+    }
+}
+
+/**
+ * @brief Kalman filter update step with a scalar measurement
+ *
+ * y = z - H * x \n
+ * S = H * P * H^T + R \n
+ * K = P * H^T / S \n
+ * x = x + K * y \n
+ * P = P - K * (P * H^T)^T
+ *
+ * @note The DSP engine must be in the mode given by CORCON_MODE_FP_LIB (see fp_lib_corcon.h)
+ * @note This function executes in approx. 170 (n = 1), 400 (n = 2), 700 (n = 3) or 1090 (n = 4) CPU clock cycles (using compiler option -o2)
+ * @param kf    Pointer to Kalman filter
+ * @param z     Measurement in Q0.15 format
+ * @return      Innovation y in Q0.15 format
+ */
+inline static _Q15 kalmanUpdate_Q15(Kalman_Q15 * const kf, const _Q15 z)
+{
+    const uint16_t n = kf->n;
+
+    // Innovation y = z - H * x
+    const _Q15 y = kalmanMsc_Q15(z, kf->H, kf->x, n);
+
+    // P * H^T and innovation variance S = H * P * H^T + R
+    _Q31 PHt[KALMAN_MAX_STATES];
+    _Q31 S = kf->R;
+    for (uint16_t i = 0; i < n; ++i)
+    {
+        _Q31 sum = 0;
+        for (uint16_t k = 0; k < n; ++k)
+        {
+            sum = add_Q31_Sat(sum, mul_Q31_Q15(kf->P[i][k], kf->H[k]));
+        }
+        PHt[i] = sum;
+        S = add_Q31_Sat(S, mul_Q31_Q15(sum, kf->H[i]));
+    }
+
+    if (S <= 0)
+    {
+        // Degenerate innovation variance, skip update
+        return y;
+    }
+
+    // Kalman gain and state update
+    _Q15 K[KALMAN_MAX_STATES];
+    for (uint16_t i = 0; i < n; ++i)
+    {
+        K[i] = kalmanGain_Q15(PHt[i], S);
+        kf->x[i] = kalmanMacScalar_Q15(kf->x[i], K[i], y);
+    }
+
+    // Covariance update, upper triangle mirrored to lower triangle
+    for (uint16_t i = 0; i < n; ++i)
+    {
+        for (uint16_t j = i; j < n; ++j)
+        {
+            const _Q31 p = sub_Q31_Sat(kf->P[i][j], mul_Q31_Q15(PHt[j], K[i]));
+            kf->P[i][j] = p;
+            kf->P[j][i] = p;
+        }
+    }
+
+    return y;
+}
+
+#endif
@@ -0,0 +1,451 @@
+/*
+Copyright (C) 2022 Andreas Lagler
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file fp_lib_matrix.h
+ * @brief Matrix-vector and matrix-matrix products for fixed point types
+ *
+ * This file is part of FP-Lib Fixed-point math library for dsPIC33 family of Microchip dsPIC digital signal controllers
+ */
+
+#ifndef FP_LIB_MATRIX_H
+#define	FP_LIB_MATRIX_H
+
+#include "fp_lib_types.h"
+
+#include <stdint.h>
+
+/**
+ * @brief Product of a 2x2 matrix and a vector in Q0.15 format
+ *
+ * y = mat * x
+ *
+ * The product is unrolled completely, matrix and vector are prefetched while accumulating.
+ *
+ * @note The results are rounded according to CORCON.RND and saturated to Q0.15
+ * @note mat must be located in X data memory, x must be located in Y data memory
+ * @note This function executes in 12 CPU clock cycles (using compiler option -o2)
+ * @param mat   Pointer to 2x2 matrix in Q0.15 format (row-major)
+ * @param x     Pointer to vector of length 2 in Q0.15 format
+ * @param y     Pointer to result vector of length 2 in Q0.15 format
+ */
+inline static void matvec2_Q15(
+                               const _Q15 * mat,
+                               const _Q15 * const x,
+                               _Q15 * y)
+{
+    // Prefetch registers and vector pointer
+    _Q15 m;
+    _Q15 v;
+    const _Q15 * pv;
+
+    __asm__ volatile(
+            "\
+        mov     %[x], %[pv]                         ;Row 0: reset vector pointer \n \
+        clr     A, [%[mat]]+=2, %[m], [%[pv]]+=2, %[v] ;Prefetch first elements \n \
+        mac     %[m] * %[v], A, [%[mat]]+=2, %[m], [%[pv]]+=2, %[v] ;Multiply-accumulate, prefetch next elements \n \
+        mac     %[m] * %[v], A                      ;Multiply-accumulate last elements \n \
+        sac.r   A, #0, [%[y]++]                     ;Store result \n \
+        mov     %[x], %[pv]                         ;Row 1: reset vector pointer \n \
+        clr     A, [%[mat]]+=2, %[m], [%[pv]]+=2, %[v] ;Prefetch first elements \n \
+        mac     %[m] * %[v], A, [%[mat]]+=2, %[m], [%[pv]]+=2, %[v] ;Multiply-accumulate, prefetch next elements \n \
+        mac     %[m] * %[v], A                      ;Multiply-accumulate last elements \n \
+        sac.r   A, #0, [%[y]++]                     ;Store result \n \
+        ;10 cycles total"
+            : [mat] "+x"(mat), [y] "+r"(y), [pv] "=&y"(pv), [m] "=&z"(m), [v] "=&z"(v) /*out*/
+            : [x] "r"(x) /*in*/
+            : "memory" /*clobbered*/
+            );
+}
+
+/**
+ * @brief Product of a 3x3 matrix and a vector in Q0.15 format
+ *
+ * y = mat * x
+ *
+ * The product is unrolled completely, matrix and vector are prefetched while accumulating.
+ *
+ * @note The results are rounded according to CORCON.RND and saturated to Q0.15
+ * @note mat must be located in X data memory, x must be located in Y data memory
+ * @note This function executes in 20 CPU clock cycles (using compiler option -o2)
+ * @param mat   Pointer to 3x3 matrix in Q0.15 format (row-major)
+ * @param x     Pointer to vector of length 3 in Q0.15 format
+ * @param y     Pointer to result vector of length 3 in Q0.15 format
+ */
+inline static void matvec3_Q15(
+                               const _Q15 * mat,
+                               const _Q15 * const x,
+                               _Q15 * y)
+{
+    // Prefetch registers and vector pointer
+    _Q15 m;
+    _Q15 v;
+    const _Q15 * pv;
+
+    __asm__ volatile(
+            "\
+        mov     %[x], %[pv]                         ;Row 0: reset vector pointer \n \
+        clr     A, [%[mat]]+=2, %[m], [%[pv]]+=2, %[v] ;Prefetch first elements \n \
+        mac     %[m] * %[v], A, [%[mat]]+=2, %[m], [%[pv]]+=2, %[v] ;Multiply-accumulate, prefetch next elements \n \
+        mac     %[m] * %[v], A, [%[mat]]+=2, %[m], [%[pv]]+=2, %[v] ; \n \
+        mac     %[m] * %[v], A                      ;Multiply-accumulate last elements \n \
+        sac.r   A, #0, [%[y]++]                     ;Store result \n \
+        mov     %[x], %[pv]                         ;Row 1: reset vector pointer \n \
+        clr     A, [%[mat]]+=2, %[m], [%[pv]]+=2, %[v] ;Prefetch first elements \n \
+        mac     %[m] * %[v], A, [%[mat]]+=2, %[m], [%[pv]]+=2, %[v] ;Multiply-accumulate, prefetch next elements \n \
+        mac     %[m] * %[v], A, [%[mat]]+=2, %[m], [%[pv]]+=2, %[v] ; \n \
+        mac     %[m] * %[v], A                      ;Multiply-accumulate last elements \n \
+        sac.r   A, #0, [%[y]++]                     ;Store result \n \
+        mov     %[x], %[pv]                         ;Row 2: reset vector pointer \n \
+        clr     A, [%[mat]]+=2, %[m], [%[pv]]+=2, %[v] ;Prefetch first elements \n \
+        mac     %[m] * %[v], A, [%[mat]]+=2, %[m], [%[pv]]+=2, %[v] ;Multiply-accumulate, prefetch next elements \n \
+        mac     %[m] * %[v], A, [%[mat]]+=2, %[m], [%[pv]]+=2, %[v] ; \n \
+        mac     %[m] * %[v], A                      ;Multiply-accumulate last elements \n \
+        sac.r   A, #0, [%[y]++]                     ;Store result \n \
+        ;18 cycles total"
+            : [mat] "+x"(mat), [y] "+r"(y), [pv] "=&y"(pv), [m] "=&z"(m), [v] "=&z"(v) /*out*/
+            : [x] "r"(x) /*in*/
+            : "memory" /*clobbered*/
+            );
+}
+
+/**
+ * @brief Product of a 4x4 matrix and a vector in Q0.15 format
+ *
+ * y = mat * x
+ *
+ * The product is unrolled completely, matrix and vector are prefetched while accumulating.
+ *
+ * @note The results are rounded according to CORCON.RND and saturated to Q0.15
+ * @note mat must be located in X data memory, x must be located in Y data memory
+ * @note This function executes in 30 CPU clock cycles (using compiler option -o2)
+ * @param mat   Pointer to 4x4 matrix in Q0.15 format (row-major)
+ * @param x     Pointer to vector of length 4 in Q0.15 format
+ * @param y     Pointer to result vector of length 4 in Q0.15 format
+ */
+inline static void matvec4_Q15(
+                               const _Q15 * mat,
+                               const _Q15 * const x,
+                               _Q15 * y)
+{
+    // Prefetch registers and vector pointer
+    _Q15 m;
+    _Q15 v;
+    const _Q15 * pv;
+
+    __asm__ volatile(
+            "\
+        mov     %[x], %[pv]                         ;Row 0: reset vector pointer \n \
+        clr     A, [%[mat]]+=2, %[m], [%[pv]]+=2, %[v] ;Prefetch first elements \n \
+        mac     %[m] * %[v], A, [%[mat]]+=2, %[m], [%[pv]]+=2, %[v] ;Multiply-accumulate, prefetch next elements \n \
+        mac     %[m] * %[v], A, [%[mat]]+=2, %[m], [%[pv]]+=2, %[v] ; \n \
+        mac     %[m] * %[v], A, [%[mat]]+=2, %[m], [%[pv]]+=2, %[v] ; \n \
+        mac     %[m] * %[v], A                      ;Multiply-accumulate last elements \n \
+        sac.r   A, #0, [%[y]++]                     ;Store result \n \
+        mov     %[x], %[pv]                         ;Row 1: reset vector pointer \n \
+        clr     A, [%[mat]]+=2, %[m], [%[pv]]+=2, %[v] ;Prefetch first elements \n \
+        mac     %[m] * %[v], A, [%[mat]]+=2, %[m], [%[pv]]+=2, %[v] ;Multiply-accumulate, prefetch next elements \n \
+        mac     %[m] * %[v], A, [%[mat]]+=2, %[m], [%[pv]]+=2, %[v] ; \n \
+        mac     %[m] * %[v], A, [%[mat]]+=2, %[m], [%[pv]]+=2, %[v] ; \n \
+        mac     %[m] * %[v], A                      ;Multiply-accumulate last elements \n \
+        sac.r   A, #0, [%[y]++]                     ;Store result \n \
+        mov     %[x], %[pv]                         ;Row 2: reset vector pointer \n \
+        clr     A, [%[mat]]+=2, %[m], [%[pv]]+=2, %[v] ;Prefetch first elements \n \
+        mac     %[m] * %[v], A, [%[mat]]+=2, %[m], [%[pv]]+=2, %[v] ;Multiply-accumulate, prefetch next elements \n \
+        mac     %[m] * %[v], A, [%[mat]]+=2, %[m], [%[pv]]+=2, %[v] ; \n \
+        mac     %[m] * %[v], A, [%[mat]]+=2, %[m], [%[pv]]+=2, %[v] ; \n \
+        mac     %[m] * %[v], A                      ;Multiply-accumulate last elements \n \
+        sac.r   A, #0, [%[y]++]                     ;Store result \n \
+        mov     %[x], %[pv]                         ;Row 3: reset vector pointer \n \
+        clr     A, [%[mat]]+=2, %[m], [%[pv]]+=2, %[v] ;Prefetch first elements \n \
+        mac     %[m] * %[v], A, [%[mat]]+=2, %[m], [%[pv]]+=2, %[v] ;Multiply-accumulate, prefetch next elements \n \
+        mac     %[m] * %[v], A, [%[mat]]+=2, %[m], [%[pv]]+=2, %[v] ; \n \
+        mac     %[m] * %[v], A, [%[mat]]+=2, %[m], [%[pv]]+=2, %[v] ; \n \
+        mac     %[m] * %[v], A                      ;Multiply-accumulate last elements \n \
+        sac.r   A, #0, [%[y]++]                     ;Store result \n \
+        ;28 cycles total"
+            : [mat] "+x"(mat), [y] "+r"(y), [pv] "=&y"(pv), [m] "=&z"(m), [v] "=&z"(v) /*out*/
+            : [x] "r"(x) /*in*/
+            : "memory" /*clobbered*/
+            );
+}
+
+/**
+ * @brief Product of a matrix and a vector in Q0.15 format
+ *
+ * y = mat * x
+ *
+ * Each row is accumulated in accA by a repeated mac instruction, matrix and vector are prefetched while accumulating.
+ *
+ * @note The results are rounded according to CORCON.RND and saturated to Q0.15
+ * @note mat must be located in X data memory, x must be located in Y data memory
+ * @note This function executes in 3 + (cols + 4) * rows CPU clock cycles (using compiler option -o2)
+ * @param mat   Pointer to rows x cols matrix in Q0.15 format (row-major)
+ * @param x     Pointer to vector of length cols in Q0.15 format
+ * @param y     Pointer to result vector of length rows in Q0.15 format
+ * @param rows  Number of matrix rows
+ * @param cols  Number of matrix columns (at least 2)
+ */
+inline static void matvec_Q15(
+                              const _Q15 * mat,
+                              const _Q15 * const x,
+                              _Q15 * y,
+                              const uint16_t rows,
+                              const uint16_t cols)
+{
+    // Prefetch registers and vector pointer
+    _Q15 m;
+    _Q15 v;
+    const _Q15 * pv;
+
+    __asm__ volatile(
+            "\
+        do      %[rows], matvec_Q15_end_%=          ;Init Loop over rows \n \
+        mov     %[x], %[pv]                         ;Reset vector pointer \n \
+        clr     A, [%[mat]]+=2, %[m], [%[pv]]+=2, %[v] ;Prefetch first elements \n \
+        repeat  %[cols]                             ;Repeat cols - 1 times \n \
+        mac     %[m] * %[v], A, [%[mat]]+=2, %[m], [%[pv]]+=2, %[v] ;Multiply-accumulate, prefetch next elements \n \
+        mac     %[m] * %[v], A                      ;Multiply-accumulate last elements \n \
+        matvec_Q15_end_%=:                          ;\n \
+        sac.r   A, #0, [%[y]++]                     ;Store result \n \
+        ; 2 + (cols + 4) * rows cycles total, 1 DO level"
+            : [mat] "+x"(mat), [y] "+r"(y), [pv] "=&y"(pv), [m] "=&z"(m), [v] "=&z"(v) /*out*/
+            : [x] "r"(x), [rows] "r"(rows - 1), [cols] "r"(cols - 2) /*in*/
+            : "memory" /*clobbered*/
+            );
+}
+
+/**
+ * @brief Product of two 2x2 matrices in Q0.15 format
+ *
+ * c = a * b
+ *
+ * The product is unrolled completely. The rows of a are prefetched through the X data bus, the columns of b are prefetched
+ * through the Y data bus with a stride of 4 bytes.
+ *
+ * @note The results are rounded according to CORCON.RND and saturated to Q0.15
+ * @note a must be located in X data memory, b must be located in Y data memory
+ * @note This function executes in 26 CPU clock cycles (using compiler option -o2)
+ * @param a     Pointer to 2x2 matrix in Q0.15 format (row-major)
+ * @param b     Pointer to 2x2 matrix in Q0.15 format (row-major)
+ * @param c     Pointer to 2x2 result matrix in Q0.15 format (row-major)
+ */
+inline static void matmul2_Q15(
+                               const _Q15 * const a,
+                               const _Q15 * const b,
+                               _Q15 * c)
+{
+    // Prefetch registers and working pointers
+    _Q15 m;
+    _Q15 v;
+    const _Q15 * pa;
+    const _Q15 * pb;
+
+    __asm__ volatile(
+            "\
+        mov     %[a], %[pa]                         ;c[0][0]: row 0 of a \n \
+        mov     %[b], %[pb]                         ;Column 0 of b \n \
+        clr     A, [%[pa]]+=2, %[m], [%[pb]]+=4, %[v] ;Prefetch first elements \n \
+        mac     %[m] * %[v], A, [%[pa]]+=2, %[m], [%[pb]]+=4, %[v] ;Multiply-accumulate, prefetch next elements \n \
+        mac     %[m] * %[v], A                      ;Multiply-accumulate last elements \n \
+        sac.r   A, #0, [%[c]++]                     ;Store result \n \
+        mov     %[a], %[pa]                         ;c[0][1]: row 0 of a \n \
+        add     %[b], #2, %[pb]                     ;Column 1 of b \n \
+        clr     A, [%[pa]]+=2, %[m], [%[pb]]+=4, %[v] ;Prefetch first elements \n \
+        mac     %[m] * %[v], A, [%[pa]]+=2, %[m], [%[pb]]+=4, %[v] ;Multiply-accumulate, prefetch next elements \n \
+        mac     %[m] * %[v], A                      ;Multiply-accumulate last elements \n \
+        sac.r   A, #0, [%[c]++]                     ;Store result \n \
+        add     %[a], #4, %[pa]                     ;c[1][0]: row 1 of a \n \
+        mov     %[b], %[pb]                         ;Column 0 of b \n \
+        clr     A, [%[pa]]+=2, %[m], [%[pb]]+=4, %[v] ;Prefetch first elements \n \
+        mac     %[m] * %[v], A, [%[pa]]+=2, %[m], [%[pb]]+=4, %[v] ;Multiply-accumulate, prefetch next elements \n \
+        mac     %[m] * %[v], A                      ;Multiply-accumulate last elements \n \
+        sac.r   A, #0, [%[c]++]                     ;Store result \n \
+        add     %[a], #4, %[pa]                     ;c[1][1]: row 1 of a \n \
+        add     %[b], #2, %[pb]                     ;Column 1 of b \n \
+        clr     A, [%[pa]]+=2, %[m], [%[pb]]+=4, %[v] ;Prefetch first elements \n \
+        mac     %[m] * %[v], A, [%[pa]]+=2, %[m], [%[pb]]+=4, %[v] ;Multiply-accumulate, prefetch next elements \n \
+        mac     %[m] * %[v], A                      ;Multiply-accumulate last elements \n \
+        sac.r   A, #0, [%[c]++]                     ;Store result \n \
+        ;24 cycles total"
+            : [c] "+r"(c), [pa] "=&x"(pa), [pb] "=&y"(pb), [m] "=&z"(m), [v] "=&z"(v) /*out*/
+            : [a] "r"(a), [b] "r"(b) /*in*/
+            : "memory" /*clobbered*/
+            );
+}
+
+/**
+ * @brief Product of two 3x3 matrices in Q0.15 format
+ *
+ * c = a * b
+ *
+ * The product is unrolled completely. The rows of a are prefetched through the X data bus, the columns of b are prefetched
+ * through the Y data bus with a stride of 6 bytes.
+ *
+ * @note The results are rounded according to CORCON.RND and saturated to Q0.15
+ * @note a must be located in X data memory, b must be located in Y data memory
+ * @note This function executes in 65 CPU clock cycles (using compiler option -o2)
+ * @param a     Pointer to 3x3 matrix in Q0.15 format (row-major)
+ * @param b     Pointer to 3x3 matrix in Q0.15 format (row-major)
+ * @param c     Pointer to 3x3 result matrix in Q0.15 format (row-major)
+ */
+inline static void matmul3_Q15(
+                               const _Q15 * const a,
+                               const _Q15 * const b,
+                               _Q15 * c)
+{
+    // Prefetch registers and working pointers
+    _Q15 m;
+    _Q15 v;
+    const _Q15 * pa;
+    const _Q15 * pb;
+
+    __asm__ volatile(
+            "\
+        mov     %[a], %[pa]                         ;c[0][0]: row 0 of a \n \
+        mov     %[b], %[pb]                         ;Column 0 of b \n \
+        clr     A, [%[pa]]+=2, %[m], [%[pb]]+=6, %[v] ;Prefetch first elements \n \
+        mac     %[m] * %[v], A, [%[pa]]+=2, %[m], [%[pb]]+=6, %[v] ;Multiply-accumulate, prefetch next elements \n \
+        mac     %[m] * %[v], A, [%[pa]]+=2, %[m], [%[pb]]+=6, %[v] ; \n \
+        mac     %[m] * %[v], A                      ;Multiply-accumulate last elements \n \
+        sac.r   A, #0, [%[c]++]                     ;Store result \n \
+        mov     %[a], %[pa]                         ;c[0][1]: row 0 of a \n \
+        add     %[b], #2, %[pb]                     ;Column 1 of b \n \
+        clr     A, [%[pa]]+=2, %[m], [%[pb]]+=6, %[v] ;Prefetch first elements \n \
+        mac     %[m] * %[v], A, [%[pa]]+=2, %[m], [%[pb]]+=6, %[v] ;Multiply-accumulate, prefetch next elements \n \
+        mac     %[m] * %[v], A, [%[pa]]+=2, %[m], [%[pb]]+=6, %[v] ; \n \
+        mac     %[m] * %[v], A                      ;Multiply-accumulate last elements \n \
+        sac.r   A, #0, [%[c]++]                     ;Store result \n \
+        mov     %[a], %[pa]                         ;c[0][2]: row 0 of a \n \
+        add     %[b], #4, %[pb]                     ;Column 2 of b \n \
+        clr     A, [%[pa]]+=2, %[m], [%[pb]]+=6, %[v] ;Prefetch first elements \n \
+        mac     %[m] * %[v], A, [%[pa]]+=2, %[m], [%[pb]]+=6, %[v] ;Multiply-accumulate, prefetch next elements \n \
+        mac     %[m] * %[v], A, [%[pa]]+=2, %[m], [%[pb]]+=6, %[v] ; \n \
+        mac     %[m] * %[v], A                      ;Multiply-accumulate last elements \n \
+        sac.r   A, #0, [%[c]++]                     ;Store result \n \
+        add     %[a], #6, %[pa]                     ;c[1][0]: row 1 of a \n \
+        mov     %[b], %[pb]                         ;Column 0 of b \n \
+        clr     A, [%[pa]]+=2, %[m], [%[pb]]+=6, %[v] ;Prefetch first elements \n \
+        mac     %[m] * %[v], A, [%[pa]]+=2, %[m], [%[pb]]+=6, %[v] ;Multiply-accumulate, prefetch next elements \n \
+        mac     %[m] * %[v], A, [%[pa]]+=2, %[m], [%[pb]]+=6, %[v] ; \n \
+        mac     %[m] * %[v], A                      ;Multiply-accumulate last elements \n \
+        sac.r   A, #0, [%[c]++]                     ;Store result \n \
+        add     %[a], #6, %[pa]                     ;c[1][1]: row 1 of a \n \
+        add     %[b], #2, %[pb]                     ;Column 1 of b \n \
+        clr     A, [%[pa]]+=2, %[m], [%[pb]]+=6, %[v] ;Prefetch first elements \n \
+        mac     %[m] * %[v], A, [%[pa]]+=2, %[m], [%[pb]]+=6, %[v] ;Multiply-accumulate, prefetch next elements \n \
+        mac     %[m] * %[v], A, [%[pa]]+=2, %[m], [%[pb]]+=6, %[v] ; \n \
+        mac     %[m] * %[v], A                      ;Multiply-accumulate last elements \n \
+        sac.r   A, #0, [%[c]++]                     ;Store result \n \
+        add     %[a], #6, %[pa]                     ;c[1][2]: row 1 of a \n \
+        add     %[b], #4, %[pb]                     ;Column 2 of b \n \
+        clr     A, [%[pa]]+=2, %[m], [%[pb]]+=6, %[v] ;Prefetch first elements \n \
+        mac     %[m] * %[v], A, [%[pa]]+=2, %[m], [%[pb]]+=6, %[v] ;Multiply-accumulate, prefetch next elements \n \
+        mac     %[m] * %[v], A, [%[pa]]+=2, %[m], [%[pb]]+=6, %[v] ; \n \
+        mac     %[m] * %[v], A                      ;Multiply-accumulate last elements \n \
+        sac.r   A, #0, [%[c]++]                     ;Store result \n \
+        add     %[a], #12, %[pa]                    ;c[2][0]: row 2 of a \n \
+        mov     %[b], %[pb]                         ;Column 0 of b \n \
+        clr     A, [%[pa]]+=2, %[m], [%[pb]]+=6, %[v] ;Prefetch first elements \n \
+        mac     %[m] * %[v], A, [%[pa]]+=2, %[m], [%[pb]]+=6, %[v] ;Multiply-accumulate, prefetch next elements \n \
+        mac     %[m] * %[v], A, [%[pa]]+=2, %[m], [%[pb]]+=6, %[v] ; \n \
+        mac     %[m] * %[v], A                      ;Multiply-accumulate last elements \n \
+        sac.r   A, #0, [%[c]++]                     ;Store result \n \
+        add     %[a], #12, %[pa]                    ;c[2][1]: row 2 of a \n \
+        add     %[b], #2, %[pb]                     ;Column 1 of b \n \
+        clr     A, [%[pa]]+=2, %[m], [%[pb]]+=6, %[v] ;Prefetch first elements \n \
+        mac     %[m] * %[v], A, [%[pa]]+=2, %[m], [%[pb]]+=6, %[v] ;Multiply-accumulate, prefetch next elements \n \
+        mac     %[m] * %[v], A, [%[pa]]+=2, %[m], [%[pb]]+=6, %[v] ; \n \
+        mac     %[m] * %[v], A                      ;Multiply-accumulate last elements \n \
+        sac.r   A, #0, [%[c]++]                     ;Store result \n \
+        add     %[a], #12, %[pa]                    ;c[2][2]: row 2 of a \n \
+        add     %[b], #4, %[pb]                     ;Column 2 of b \n \
+        clr     A, [%[pa]]+=2, %[m], [%[pb]]+=6, %[v] ;Prefetch first elements \n \
+        mac     %[m] * %[v], A, [%[pa]]+=2, %[m], [%[pb]]+=6, %[v] ;Multiply-accumulate, prefetch next elements \n \
+        mac     %[m] * %[v], A, [%[pa]]+=2, %[m], [%[pb]]+=6, %[v] ; \n \
+        mac     %[m] * %[v], A                      ;Multiply-accumulate last elements \n \
+        sac.r   A, #0, [%[c]++]                     ;Store result \n \
+        ;63 cycles total"
+            : [c] "+r"(c), [pa] "=&x"(pa), [pb] "=&y"(pb), [m] "=&z"(m), [v] "=&z"(v) /*out*/
+            : [a] "r"(a), [b] "r"(b) /*in*/
+            : "memory" /*clobbered*/
+            );
+}
+
+/**
+ * @brief Product of two matrices in Q0.15 format
+ *
+ * c = a * b
+ *
+ * Each element of c is accumulated in accA. The rows of a are prefetched while accumulating, the columns of b are read with a stride of cols elements.
+ * Use matmul2_Q15() or matmul3_Q15() for 2x2 and 3x3 matrices, which prefetch the columns of b as well.
+ *
+ * @note The results are rounded according to CORCON.RND and saturated to Q0.15
+ * @note a must be located in X data memory, one element beyond the end of a is read (but not used) by the final prefetch
+ * @note This function executes in approx. (4 + (7 + 3 * inner) * cols) * rows CPU clock cycles (using compiler option -o2)
+ * @param a     Pointer to rows x inner matrix in Q0.15 format (row-major)
+ * @param b     Pointer to inner x cols matrix in Q0.15 format (row-major)
+ * @param c     Pointer to rows x cols result matrix in Q0.15 format (row-major)
+ * @param rows  Number of rows of a and c
+ * @param inner Number of columns of a and rows of b
+ * @param cols  Number of columns of b and c
+ */
+inline static void matmul_Q15(
+                              const _Q15 * a,
+                              const _Q15 * const b,
+                              _Q15 * c,
+                              const uint16_t rows,
+                              const uint16_t inner,
+                              const uint16_t cols)
+{
+    // Stride between consecutive elements of a column of b in bytes
+    const uint16_t stride = cols * sizeof (_Q15);
+
+    for (uint16_t row = 0; row < rows; ++row)
+    {
+        // Prefetch registers, working pointers and pointer to current column of b
+        _Q15 m;
+        _Q15 v;
+        const _Q15 * pa;
+        const _Q15 * pb;
+        const _Q15 * col = b;
+
+        __asm__ volatile(
+                "\
+            do      %[cols], matmul_Q15_end_%=      ;Init Loop over columns \n \
+            mov     %[a], %[pa]                     ;Reset row pointer \n \
+            mov     %[col], %[pb]                   ;Reset column pointer \n \
+            clr     A, [%[pa]]+=2, %[m]             ;Prefetch first element of row \n \
+            do      %[inner], matmul_Q15_dot_%=     ;Init Loop over row/column elements \n \
+            mov     [%[pb]], %[v]                   ;Load column element \n \
+            add     %[pb], %[stride], %[pb]         ;Advance to next column element \n \
+            matmul_Q15_dot_%=:                      ;\n \
+            mac     %[m] * %[v], A, [%[pa]]+=2, %[m] ;Multiply-accumulate, prefetch next row element \n \
+            inc2    %[col], %[col]                  ;Advance to next column \n \
+            matmul_Q15_end_%=:                      ;\n \
+            sac.r   A, #0, [%[c]++]                 ;Store result \n \
+            ; 2 + (7 + 3 * inner) * cols cycles total, 2 DO levels"
+                : [c] "+r"(c), [col] "+r"(col), [pa] "=&x"(pa), [pb] "=&r"(pb), [m] "=&z"(m), [v] "=&z"(v) /*out*/
+                : [a] "r"(a), [stride] "r"(stride), [inner] "r"(inner - 1), [cols] "r"(cols - 1) /*in*/
+                : "memory" /*clobbered*/
+                );
+
+        a += inner;
+    }
+}
+
+#endif
@@ -0,0 +1,207 @@
+/*
+Copyright (C) 2022 Andreas Lagler
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file fp_lib_minmax.h
+ * @brief Minimum/maximum reduction routines for fixed point types
+ *
+ * This file is part of FP-Lib Fixed-point math library for dsPIC33 family of Microchip dsPIC digital signal controllers
+ */
+
+#ifndef FP_LIB_MINMAX_H
+#define	FP_LIB_MINMAX_H
+
+#include "fp_lib_types.h"
+
+#include <stdint.h>
+
+/**
+ * @brief Maximum of an array in Q0.15 format
+ * @note The maximum is updated by compare-and-skip instructions, so the execution time does not depend on the data
+ * @note This function executes in 4 + 3 * len CPU clock cycles (using compiler option -o2)
+ * @param src   Pointer to array in Q0.15 format
+ * @param len   Number of array elements (at least 1)
+ * @return      Maximum of array in Q0.15 format
+ */
+inline static _Q15 max_aQ15(
+                            const _Q15 * src,
+                            const uint16_t len)
+{
+    // Result
+    _Q15 max;
+
+    // Array element
+    _Q15 val;
+
+    __asm__ volatile(
+            "\
+        mov     #0x8000, %[max]                     ;Start with minimum of Q0.15 \n \
+        do      %[len], max_aQ15_end_%=             ;Init Loop \n \
+        mov     [%[src]++], %[val]                  ;Load array element \n \
+        cpsgt   %[max], %[val]                      ;Compare max and val, skip if greater \n \
+        max_aQ15_end_%=:                            ;\n \
+        mov     %[val], %[max]                      ;max = val \n \
+        ; 3 + 3 * len cycles total, 1 DO level"
+            : [max] "=&r"(max), [val] "=&r"(val), [src] "+r"(src) /*out*/
+            : [len] "r"(len - 1) /*in*/
+            : "memory" /*clobbered*/
+            );
+
+    return max;
+}
+
+/**
+ * @brief Minimum of an array in Q0.15 format
+ * @note The minimum is updated by compare-and-skip instructions, so the execution time does not depend on the data
+ * @note This function executes in 4 + 3 * len CPU clock cycles (using compiler option -o2)
+ * @param src   Pointer to array in Q0.15 format
+ * @param len   Number of array elements (at least 1)
+ * @return      Minimum of array in Q0.15 format
+ */
+inline static _Q15 min_aQ15(
+                            const _Q15 * src,
+                            const uint16_t len)
+{
+    // Result
+    _Q15 min;
+
+    // Array element
+    _Q15 val;
+
+    __asm__ volatile(
+            "\
+        mov     #0x7FFF, %[min]                     ;Start with maximum of Q0.15 \n \
+        do      %[len], min_aQ15_end_%=             ;Init Loop \n \
+        mov     [%[src]++], %[val]                  ;Load array element \n \
+        cpslt   %[min], %[val]                      ;Compare min and val, skip if less \n \
+        min_aQ15_end_%=:                            ;\n \
+        mov     %[val], %[min]                      ;min = val \n \
+        ; 3 + 3 * len cycles total, 1 DO level"
+            : [min] "=&r"(min), [val] "=&r"(val), [src] "+r"(src) /*out*/
+            : [len] "r"(len - 1) /*in*/
+            : "memory" /*clobbered*/
+            );
+
+    return min;
+}
+
+/**
+ * @brief Minimum and maximum of an array in Q0.15 format
+ * @note Minimum and maximum are updated by compare-and-skip instructions, so the execution time does not depend on the data
+ * @note This function executes in 6 + 5 * len CPU clock cycles (using compiler option -o2)
+ * @param src   Pointer to array in Q0.15 format
+ * @param len   Number of array elements (at least 1)
+ * @param min   Pointer to minimum of array in Q0.15 format
+ * @param max   Pointer to maximum of array in Q0.15 format
+ */
+inline static void minmax_aQ15(
+                               const _Q15 * src,
+                               const uint16_t len,
+                               _Q15 * const min,
+                               _Q15 * const max)
+{
+    // Results
+    _Q15 minRes;
+    _Q15 maxRes;
+
+    // Array element
+    _Q15 val;
+
+    __asm__ volatile(
+            "\
+        mov     #0x7FFF, %[min]                     ;Start with maximum of Q0.15 \n \
+        mov     #0x8000, %[max]                     ;Start with minimum of Q0.15 \n \
+        do      %[len], minmax_aQ15_end_%=          ;Init Loop \n \
+        mov     [%[src]++], %[val]                  ;Load array element \n \
+        cpsgt   %[max], %[val]                      ;Compare max and val, skip if greater \n \
+        mov     %[val], %[max]                      ;max = val \n \
+        cpslt   %[min], %[val]                      ;Compare min and val, skip if less \n \
+        minmax_aQ15_end_%=:                         ;\n \
+        mov     %[val], %[min]                      ;min = val \n \
+        ; 4 + 5 * len cycles total, 1 DO level"
+            : [min] "=&r"(minRes), [max] "=&r"(maxRes), [val] "=&r"(val), [src] "+r"(src) /*out*/
+            : [len] "r"(len - 1) /*in*/
+            : "memory" /*clobbered*/
+            );
+
+    *min = minRes;
+    *max = maxRes;
+}
+
+/**
+ * @brief Maximum of the modified absolute of an array in Q0.15 format, and its index
+ *
+ * The absolute is calculated as in abs_Q15(), i.e. 0x8000 is mapped to 0x7FFF.
+ * The array is scanned backwards, keeping absolute value and address in w0:w1 and maximum and its address in w2:w3.
+ * Maximum and address are updated by two compare-and-skip guarded single-cycle movs, each pair taking 2 cycles whether the mov
+ * is skipped or not. In case of multiple maxima, the index of the first one is returned.
+ *
+ * @note The execution time does not depend on the data
+ * @note This function executes in 11 + 10 * len CPU clock cycles (using compiler option -o2)
+ * @param src   Pointer to array in Q0.15 format
+ * @param len   Number of array elements (at least 1)
+ * @param index Pointer to index of maximum
+ * @return      Maximum of modified absolute of array in Q0.15 format
+ */
+inline static _Q15 maxabs_aQ15(
+                               const _Q15 * const src,
+                               const uint16_t len,
+                               uint16_t * const index)
+{
+    // Result
+    _Q15 max;
+
+    // Address of maximum
+    const _Q15 * pMax;
+
+    // Bit mask
+    _Q15 mask;
+
+    // Minimum of Q0.15
+    _Q15 min;
+
+    __asm__ volatile(
+            "\
+        mov     %[end], w1                          ;Scan backwards from the end of the array \n \
+        setm    w2                                  ;Start with max = -1 \n \
+        mov     #0x8000, %[min]                     ;Minimum of Q0.15 \n \
+        do      %[len], maxabs_aQ15_end_%=          ;Init Loop \n \
+        mov     [--w1], w0                          ;Load array element, w1 holds its address \n \
+        cpsne   w0, %[min]                          ;Compare val and minimum, skip if not equal \n \
+        mov     #0x7FFF, w0                         ;Correct val to get the desired result \n \
+        asr     w0, #15, %[mask]                    ;Use bitmask to calculate two's complement of val \n \
+        add     %[mask], w0, w0                     ;Subtract one (step 2 of two's complement calculation) \n \
+        xor     %[mask], w0, w0                     ;Invert bit-wise for negative numbers \n \
+        cpsgt   w2, w0                              ;Compare max and abs(val), skip if greater \n \
+        mov     w1, w3                              ;Update address of max \n \
+        cpsgt   w2, w0                              ;Compare max and abs(val), skip if greater \n \
+        maxabs_aQ15_end_%=:                         ;\n \
+        mov     w0, w2                              ;Update max \n \
+        mov     w2, %[max]                          ;Store max \n \
+        mov     w3, %[pMax]                         ;Store address of max \n \
+        ; 7 + 10 * len cycles total, 1 DO level"
+            : [max] "=&r"(max), [pMax] "=&r"(pMax), [mask] "=&r"(mask), [min] "=&r"(min) /*out*/
+            : [end] "r"(src + len), [len] "r"(len - 1) /*in*/
+            : "w0", "w1", "w2", "w3" /*clobbered*/
+            );
+
+    *index = pMax - src;
+
+    return max;
+}
+
+#endif
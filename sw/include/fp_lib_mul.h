@@ -26,6 +26,7 @@ along with this program. If not, see <https://www.gnu.org/licenses/>.
 #define	FP_LIB_MUL_H
 
 #include "fp_lib_types.h"
+#include "fp_lib_corcon.h"
 
 /**
  * @brief Multiplication of two scalars in Q0.15 format
@@ -42,6 +43,48 @@ inline static _Q15 mul_Q15_Q15(const _Q15 arg1, const _Q15 arg2)
     return res.high;
 }
 
+/**
+ * @brief Multiplication of two scalars in Q0.15 format
+ * @note The multiplication result is rounded to nearest Q0.15 (conventional rounding, ties rounded up)
+ * @note As for mul_Q15_Q15(), the product -1.0 * -1.0 is not saturated
+ * @note This function executes in 5 CPU clock cycles (using compiler option -o2)
+ * @param arg1 Scalar factor in Q0.15 format
+ * @param arg2 Scalar factor in Q0.15 format
+ * @return Multiplication result in Q0.15 format
+ */
+inline static _Q15 mul_Q15_Q15_Rnd(const _Q15 arg1, const _Q15 arg2)
+{
+    // The result of the direct multiplication is Q1.30, add 0.5 LSB of Q0.15 before truncation
+    const Long res = {.value = (__builtin_mulss(arg1, arg2) + 0x4000) << 1};
+    return res.high;
+}
+
+/**
+ * @brief Multiplication of two scalars in Q0.15 format
+ * @note The multiplication result is rounded to nearest Q0.15 (convergent rounding, ties rounded to even) and saturated
+ * @note Rounding is done by sac.r, i.e. CORCON.RND must be cleared (see CORCON_MODE_FP_LIB)
+ * @note This function executes in 4 CPU clock cycles (using compiler option -o2)
+ * @param arg1 Scalar factor in Q0.15 format
+ * @param arg2 Scalar factor in Q0.15 format
+ * @return Multiplication result in Q0.15 format
+ */
+inline static _Q15 mul_Q15_Q15_RndConvergent(const _Q15 arg1, const _Q15 arg2)
+{
+    _Q15 res;
+
+    __asm__ volatile(
+            "\
+        mpy     %[arg1] * %[arg2], A                ;Multiply in A \n \
+        sac.r   A, #0, %[res]                       ;Store rounded A in res \n \
+        ;2 cycles total"
+            : [res] "=r"(res) /*out*/
+            : [arg1] "z"(arg1), [arg2] "z"(arg2) /*in*/
+            : /*clobbered*/
+            );
+
+    return res;
+}
+
 /**
  * @brief Multiplication of two scalars in Q0.15 and Q0.16 format
  * @note The multiplication result is truncated to Q0.15
@@ -57,6 +100,38 @@ inline static _Q15 mul_Q15_Q16(const _Q15 arg1, const _Q16 arg2)
     return res.high;
 }
 
+/**
+ * @brief Multiplication of two scalars in Q0.15 and Q0.16 format
+ * @note The multiplication result is rounded to nearest Q0.15 (conventional rounding, ties rounded up)
+ * @note This function executes in 3 CPU clock cycles (using compiler option -o2)
+ * @param arg1 Scalar factor in Q0.15 format
+ * @param arg2 Scalar factor in Q0.16 format
+ * @return Multiplication result in Q0.15 format
+ */
+inline static _Q15 mul_Q15_Q16_Rnd(const _Q15 arg1, const _Q16 arg2)
+{
+    // The result of the direct multiplication is Q31, add 0.5 LSB of Q0.15 before truncation
+    const Long res = {.value = __builtin_mulsu(arg1, arg2) + 0x8000};
+    return res.high;
+}
+
+/**
+ * @brief Multiplication of two scalars in Q0.15 and Q0.16 format
+ * @note The multiplication result is rounded to nearest Q0.15 (convergent rounding, ties rounded to even)
+ * @note This function executes in 5 CPU clock cycles (using compiler option -o2)
+ * @param arg1 Scalar factor in Q0.15 format
+ * @param arg2 Scalar factor in Q0.16 format
+ * @return Multiplication result in Q0.15 format
+ */
+inline static _Q15 mul_Q15_Q16_RndConvergent(const _Q15 arg1, const _Q16 arg2)
+{
+    // The result of the direct multiplication is Q31
+    // Adding 0.5 LSB - 1 plus the LSB of the truncated result rounds ties to even
+    Long res = {.value = __builtin_mulsu(arg1, arg2)};
+    res.value += 0x7FFF + (res.high & 1);
+    return res.high;
+}
+
 /**
  * @brief Multiplication of two scalars in Q0.15 and Q16.16 format
  * @note The multiplication result is truncated to Q0.15 but not clipped
@@ -87,6 +162,115 @@ inline static _Q16 mul_Q16_Q16(const _Q16 arg1, const _Q16 arg2)
     return res.high;
 }
 
+/**
+ * @brief Multiplication of two scalars in Q0.16 format
+ * @note The multiplication result is rounded to nearest Q0.16 (conventional rounding, ties rounded up)
+ * @note This function executes in 3 CPU clock cycles (using compiler option -o2)
+ * @param arg1 Scalar factor in Q0.16 format
+ * @param arg2 Scalar factor in Q0.16 format
+ * @return Multiplication result in Q0.16 format
+ */
+inline static _Q16 mul_Q16_Q16_Rnd(const _Q16 arg1, const _Q16 arg2)
+{
+    // The result of the direct multiplication is Q0.32, add 0.5 LSB of Q0.16 before truncation
+    const ULong res = {.value = __builtin_muluu(arg1, arg2) + 0x8000};
+    return res.high;
+}
+
+/**
+ * @brief Multiplication of two scalars in Q0.16 format
+ * @note The multiplication result is rounded to nearest Q0.16 (convergent rounding, ties rounded to even)
+ * @note This function executes in 5 CPU clock cycles (using compiler option -o2)
+ * @param arg1 Scalar factor in Q0.16 format
+ * @param arg2 Scalar factor in Q0.16 format
+ * @return Multiplication result in Q0.16 format
+ */
+inline static _Q16 mul_Q16_Q16_RndConvergent(const _Q16 arg1, const _Q16 arg2)
+{
+    // The result of the direct multiplication is Q0.32
+    // Adding 0.5 LSB - 1 plus the LSB of the truncated result rounds ties to even
+    ULong res = {.value = __builtin_muluu(arg1, arg2)};
+    res.value += 0x7FFF + (res.high & 1);
+    return res.high;
+}
+
+/**
+ * @brief Multiplication of two scalars in Q0.31 format
+ *
+ * The four 16x16 bit partial products are summed with full precision (64 bit), so no partial product is truncated before the final result.
+ *
+ * @note The multiplication result is truncated to Q0.31
+ * @note The product -1.0 * -1.0 is not saturated
+ * @note This function executes in 18 CPU clock cycles (using compiler option -o2)
+ * @param arg1 Scalar factor in Q0.31 format
+ * @param arg2 Scalar factor in Q0.31 format
+ * @return Multiplication result in Q0.31 format
+ */
+inline static _Q31 mul_Q31_Q31(const _Q31 arg1, const _Q31 arg2)
+{
+    _Q31 res;
+
+    // Result of Q0.31 * Q0.31 multiplication is Q1.62 in 4 words s3:s2:s1:s0
+    // s0 is not needed since all other partial products start at s1
+    __asm__ volatile(
+            "\
+        mul.uu  %[arg1], %[arg2], w0                ;arg1_low * arg2_low --> s1 in w1 \n \
+        mul.su  %d[arg1], %[arg2], w2               ;arg1_high * arg2_low --> w3:w2 \n \
+        mul.su  %d[arg2], %[arg1], w4               ;arg2_high * arg1_low --> w5:w4 \n \
+        mul.ss  %d[arg1], %d[arg2], w6              ;arg1_high * arg2_high --> s3:s2 in w7:w6 \n \
+        asr     w3, #15, w0                         ;Sign extension of arg1_high * arg2_low \n \
+        add     w1, w2, w1                          ;Add arg1_high * arg2_low to s3:s2:s1 \n \
+        addc    w6, w3, w6                          ; \n \
+        addc    w7, w0, w7                          ; \n \
+        asr     w5, #15, w0                         ;Sign extension of arg2_high * arg1_low \n \
+        add     w1, w4, w1                          ;Add arg2_high * arg1_low to s3:s2:s1 \n \
+        addc    w6, w5, w6                          ; \n \
+        addc    w7, w0, w7                          ; \n \
+        sl      w1, w1                              ;Shift s3:s2:s1 left by one bit \n \
+        rlc     w6, %[res]                          ;Store Q0.31 result \n \
+        rlc     w7, %d[res]                         ; \n \
+        ;15 cycles total"
+            : [res] "=r"(res) /*out*/
+            : [arg1] "r"(arg1), [arg2] "r"(arg2) /*in*/
+            : "w0", "w1", "w2", "w3", "w4", "w5", "w6", "w7" /*clobbered*/
+            );
+
+    return res;
+}
+
+/**
+ * @brief Multiplication of two scalars in Q0.31 and Q0.15 format
+ * @note The multiplication result is truncated to Q0.31
+ * @note The product -1.0 * -1.0 is not saturated
+ * @note This function executes in 10 CPU clock cycles (using compiler option -o2)
+ * @param arg1 Scalar factor in Q0.31 format
+ * @param arg2 Scalar factor in Q0.15 format
+ * @return Multiplication result in Q0.31 format
+ */
+inline static _Q31 mul_Q31_Q15(const _Q31 arg1, const _Q15 arg2)
+{
+    _Q31 res;
+
+    // Result of Q0.31 * Q0.15 multiplication is Q1.46 in 3 words s2:s1:s0
+    __asm__ volatile(
+            "\
+        mul.su  %[arg2], %[arg1], w0                ;arg2 * arg1_low --> w1:w0 \n \
+        mul.ss  %d[arg1], %[arg2], w2               ;arg1_high * arg2 --> w3:w2 \n \
+        asr     w1, #15, w4                         ;Sign extension of arg2 * arg1_low \n \
+        add     w1, w2, w1                          ;s1 \n \
+        addc    w3, w4, w3                          ;s2 \n \
+        sl      w0, w0                              ;Shift s2:s1:s0 left by one bit \n \
+        rlc     w1, %[res]                          ;Store Q0.31 result \n \
+        rlc     w3, %d[res]                         ; \n \
+        ;8 cycles total"
+            : [res] "=r"(res) /*out*/
+            : [arg1] "r"(arg1), [arg2] "r"(arg2) /*in*/
+            : "w0", "w1", "w2", "w3", "w4" /*clobbered*/
+            );
+
+    return res;
+}
+
 /**
  * @brief Multiplication of two scalars in Q0.32 and Q0.16 format
  * @note The multiplication result is truncated to Q0.32
@@ -221,4 +405,113 @@ inline static void mul_aQ15_Q16(
             );
 }
 
+/**
+ * @brief Multiplication of array in Q0.15 format and scalar Q0.16 format
+ * @note The multiplication result is rounded to nearest Q0.15 (conventional rounding, ties rounded up)
+ * @note This function executes in 4 + 4 * len CPU clock cycles (using compiler option -o2)
+ * @param src   Pointer to array in Q0.15 format
+ * @param val   Factor in Q0.16 format
+ * @param dst   Pointer to multiplication result array in Q0.15 format
+ * @param len   Number of array elements
+ */
+inline static void mul_aQ15_Q16_Rnd(
+                                 const _Q15 * src,
+                                 const _Q16 val,
+                                 _Q15 * dst,
+                                 const uint16_t len)
+{
+    __asm__ volatile(
+            "\
+        mov     #0x8000, w2                             ;0.5 LSB of Q0.15 \n \
+        do      %[len], mul_aQ15_Q16_Rnd_end_%=         ;Init Loop \n \
+        mul.us  %[val], [%[src]++], w0                  ;Actual multiplication \n \
+        add     w0, w2, w0                              ;Add 0.5 LSB \n \
+        addc    w1, #0, w1                              ;Propagate carry \n \
+        mul_aQ15_Q16_Rnd_end_%=:                        ;\n \
+        mov     w1, [%[dst]++]                          ;Store result \n \
+        ; 4 + 4 * len cycles total, 1 DO level"
+            : [src] "+r"(src), [dst] "+r"(dst) /*out*/
+            : [val] "r"(val), [len] "r"(len - 1) /*in*/
+            : "w0", "w1", "w2", "memory" /*clobbered*/
+            );
+}
+
+/**
+ * @brief Multiplication of array in Q0.15 format and scalar Q0.15 format using the rounding mode of the DSP engine
+ *
+ * The source array is prefetched through the X data bus, the products are calculated in accA and stored by sac.r.
+ *
+ * @note The multiplication result is rounded according to CORCON.RND and saturated
+ * @note One element beyond the end of the source array is read (but not used) by the final prefetch
+ * @note This function executes in 5 + 2 * len CPU clock cycles (using compiler option -o2)
+ * @param src   Pointer to array in Q0.15 format
+ * @param val   Factor in Q0.15 format
+ * @param dst   Pointer to multiplication result array in Q0.15 format
+ * @param len   Number of array elements
+ */
+inline static void mul_aQ15_Q15_Sac(
+                                 const _Q15 * src,
+                                 const _Q15 val,
+                                 _Q15 * dst,
+                                 const uint16_t len)
+{
+    // Prefetched array element
+    _Q15 x;
+
+    __asm__ volatile(
+            "\
+        mov     [%[src]++], %[x]                        ;Prefetch first element \n \
+        do      %[len], mul_aQ15_Q15_Sac_end_%=         ;Init Loop \n \
+        mpy     %[x] * %[val], A, [%[src]]+=2, %[x]     ;Actual multiplication, prefetch next element \n \
+        mul_aQ15_Q15_Sac_end_%=:                        ;\n \
+        sac.r   A, #0, [%[dst]++]                       ;Store rounded result \n \
+        ; 3 + 2 * len cycles total, 1 DO level"
+            : [src] "+x"(src), [dst] "+r"(dst), [x] "=&z"(x) /*out*/
+            : [val] "z"(val), [len] "r"(len - 1) /*in*/
+            : "memory" /*clobbered*/
+            );
+}
+
+/**
+ * @brief Multiplication of array in Q0.15 format and scalar Q0.15 format
+ * @note The multiplication result is rounded to nearest Q0.15 (conventional rounding, ties rounded up) and saturated
+ * @note CORCON is switched to conventional rounding for the duration of the call
+ * @note This function executes in 17 + 2 * len CPU clock cycles (using compiler option -o2)
+ * @param src   Pointer to array in Q0.15 format
+ * @param val   Factor in Q0.15 format
+ * @param dst   Pointer to multiplication result array in Q0.15 format
+ * @param len   Number of array elements
+ */
+inline static void mul_aQ15_Q15_Rnd(
+                                 const _Q15 * src,
+                                 const _Q15 val,
+                                 _Q15 * dst,
+                                 const uint16_t len)
+{
+    const uint16_t corcon = corconSetMode(CORCON_MODE_FP_LIB | CORCON_RND);
+    mul_aQ15_Q15_Sac(src, val, dst, len);
+    corconRestore(corcon);
+}
+
+/**
+ * @brief Multiplication of array in Q0.15 format and scalar Q0.15 format
+ * @note The multiplication result is rounded to nearest Q0.15 (convergent rounding, ties rounded to even) and saturated
+ * @note CORCON is switched to convergent rounding for the duration of the call
+ * @note This function executes in 17 + 2 * len CPU clock cycles (using compiler option -o2)
+ * @param src   Pointer to array in Q0.15 format
+ * @param val   Factor in Q0.15 format
+ * @param dst   Pointer to multiplication result array in Q0.15 format
+ * @param len   Number of array elements
+ */
+inline static void mul_aQ15_Q15_RndConvergent(
+                                           const _Q15 * src,
+                                           const _Q15 val,
+                                           _Q15 * dst,
+                                           const uint16_t len)
+{
+    const uint16_t corcon = corconSetMode(CORCON_MODE_FP_LIB);
+    mul_aQ15_Q15_Sac(src, val, dst, len);
+    corconRestore(corcon);
+}
+
 #endif
@@ -0,0 +1,295 @@
+/*
+Copyright (C) 2022 Andreas Lagler
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file fp_lib_osc.h
+ * @brief Oscillator routines for fixed point types
+ *
+ * This file is part of FP-Lib Fixed-point math library for dsPIC33 family of Microchip dsPIC digital signal controllers
+ */
+
+#ifndef FP_LIB_OSC_H
+#define	FP_LIB_OSC_H
+
+#include "fp_lib_types.h"
+#include "fp_lib_interp.h"
+#include "fp_lib_trig.h"
+#include "fp_lib_mul.h"
+
+#include <stdint.h>
+
+/// Number of octave-spaced tables of Wavetable_Q15
+#define WAVETABLE_LEVELS 8
+
+/**
+ * @brief Set of octave-spaced band-limited wavetables (mipmap)
+ *
+ * Each table holds one period of the waveform in 256 + 1 points (see interpLUT_256_Q15()), table[l] being band-limited
+ * to harmonics 1 ... 128 >> l. Table l is alias-free for phase increments below 2^(24 + l) (Q0.32 format),
+ * i.e. fundamental frequencies below fs / 2^(8 - l).
+ * The table set is constant and may be shared by any number of oscillators.
+ */
+typedef struct
+{
+    /// Pointers to 257-point tables in Q0.15 format, from most to fewest harmonics
+    const _Q15 * table[WAVETABLE_LEVELS];
+} Wavetable_Q15;
+
+/// Wavetable oscillator state
+typedef struct
+{
+    /// Pointer to table set
+    const Wavetable_Q15 * wt;
+
+    /// Phase in Q0.32 format (full period)
+    _Q32 phase;
+} WavetableOsc_Q15;
+
+/**
+ * @brief Initialize a wavetable oscillator
+ * @param osc   Pointer to oscillator state
+ * @param wt    Pointer to table set
+ * @param phase Initial phase in Q0.32 format
+ */
+inline static void wavetableOscInit_Q15(WavetableOsc_Q15 * const osc, const Wavetable_Q15 * const wt, const _Q32 phase)
+{
+    osc->wt = wt;
+    osc->phase = phase;
+}
+
+/**
+ * @brief Generate a block of samples with a wavetable oscillator
+ *
+ * The table level is selected from the position of the leading one of the phase increment, i.e. the octave of the fundamental.
+ * Within an octave, the output is blended from the lowest alias-free table and the next table with fewer harmonics,
+ * according to the bits below the leading one. So the harmonic content changes continuously with pitch and no table switching is audible.
+ * Table selection and blend factor are calculated once per block.
+ *
+ * @note The DSP engine must be in the mode given by CORCON_MODE_FP_LIB (see fp_lib_corcon.h)
+ * @note This function executes in approx. 30 CPU clock cycles per sample, approx. 15 if only one table is used (using compiler option -o2)
+ * @param osc   Pointer to oscillator state
+ * @param inc   Phase increment per sample in Q0.32 format, i.e. f / fs * 2^32
+ * @param dst   Pointer to output block in Q0.15 format
+ * @param len   Number of samples
+ */
+inline static void wavetableOsc_aQ15(
+                                     WavetableOsc_Q15 * const osc,
+                                     const _Q32 inc,
+                                     _Q15 * dst,
+                                     uint16_t len)
+{
+    const uint16_t incHigh = ((ULong) inc).high;
+
+    // Table level l = pos - 23 with pos being the position of the leading one of inc, and blend factor in Q0.16 format
+    uint16_t level = 0;
+    _Q16 blend = 0;
+    if (incHigh >= 0x80)
+    {
+        const uint16_t pos = 32 - __builtin_ff1l(incHigh);
+        level = pos - 23;
+        blend = (uint16_t) (inc >> (pos - 16));
+    }
+    if (level >= WAVETABLE_LEVELS - 1)
+    {
+        level = WAVETABLE_LEVELS - 1;
+        blend = 0;
+    }
+
+    const _Q15 * const table0 = osc->wt->table[level];
+    ULong phase = {.value = osc->phase};
+
+    if (blend == 0)
+    {
+        while (len-- > 0)
+        {
+            *dst++ = interpLUT_256_Q15(table0, phase.high);
+            phase.value += inc;
+        }
+    }
+    else
+    {
+        const _Q15 * const table1 = osc->wt->table[level + 1];
+        while (len-- > 0)
+        {
+            const _Q15 y0 = interpLUT_256_Q15(table0, phase.high);
+            const _Q15 y1 = interpLUT_256_Q15(table1, phase.high);
+            *dst++ = interpLinear(y0, y1, blend);
+            phase.value += inc;
+        }
+    }
+
+    osc->phase = phase.value;
+}
+
+/**
+ * @brief Bank of sine oscillators in struct-of-arrays layout
+ *
+ * Phases, phase increments and amplitudes of all voices are stored in separate contiguous arrays,
+ * so the kernel walks through each array with a post-incremented pointer and no per-voice structure offsets.
+ * Increments and amplitudes may be updated by the application between blocks (e.g. for pitch bend or envelopes).
+ */
+typedef struct
+{
+    /// Number of voices (> 0)
+    uint16_t voices;
+
+    /// Pointer to phases in Q0.32 format (full period), one per voice
+    _Q32 * phase;
+
+    /// Pointer to phase increments per sample in Q0.32 format, one per voice
+    const _Q32 * inc;
+
+    /// Pointer to amplitudes in Q0.15 format, one per voice
+    const _Q15 * amp;
+} OscBank_Q15;
+
+/**
+ * @brief Generate a block of samples with a bank of sine oscillators
+ *
+ * For each output sample, all voices are advanced, their sine is calculated by the lookup of sin_Q15()
+ * and the weighted sum is accumulated in accA. The sum is saturated to Q0.15 only once per sample,
+ * so intermediate sums may exceed the range of Q0.15.
+ *
+ * @note The DSP engine must be in the mode given by CORCON_MODE_FP_LIB (see fp_lib_corcon.h)
+ * @note This function executes in approx. 10 + 14 * voices CPU clock cycles per sample (using compiler option -o2)
+ * @note The bank must hold at least one voice, voices = 0 would run the DO loop 65536 times
+ * @param bank  Pointer to oscillator bank
+ * @param dst   Pointer to output block in Q0.15 format
+ * @param len   Number of samples
+ */
+inline static void oscBankSine_aQ15(
+                                    const OscBank_Q15 * const bank,
+                                    _Q15 * dst,
+                                    uint16_t len)
+{
+    // Cached table pointer
+    const _Q15 * const yTable = sinTable_Q15;
+
+    while (len-- > 0)
+    {
+        // Array pointers
+        _Q32 * phase = bank->phase;
+        const _Q32 * inc = bank->inc;
+        const _Q15 * amp = bank->amp;
+
+        // High word of phase, sine and amplitude of current voice
+        _Q15 x;
+        _Q15 s;
+        _Q15 a;
+
+        __asm__ volatile(
+                "\
+            clr     A                                   ;Clear sum \n \
+            do      %[voices], oscBankSine_aQ15_end_%=  ;Init Loop over voices \n \
+            mov     [%[phase]], w2                      ;Load phase \n \
+            mov     [%[phase] + 2], %[x]                ; \n \
+            add     w2, [%[inc]++], w2                  ;Advance phase \n \
+            addc    %[x], [%[inc]++], %[x]              ; \n \
+            mov     w2, [%[phase]++]                    ;Store phase \n \
+            mov     %[x], [%[phase]++]                  ; \n \
+            lsr     %[x], #0x8, %[s]                    ;xInt = MSB of x = 0..255 \n \
+            sl      %[s], #2, %[s]                      ;Quadruple xInt for access of 16 bit dy|y0 pairs \n \
+            add     %[yTable], %[s], %[s]               ;s points to dy[xInt] now \n \
+            sl      %[x], #0x8, %[x]                    ;Calculate xFrac = x - xInt in upper byte \n \
+            mul.us  %[x], [%[s]++], w2                  ;Calculate dy[xInt] * xFrac, increment table pointer \n \
+            add     w3, [%[s]], %[s]                    ;add y0[xInt] \n \
+            mov     [%[amp]++], %[a]                    ;Load amplitude \n \
+            oscBankSine_aQ15_end_%=:                    ;\n \
+            mac     %[s] * %[a], A                      ;Add amplitude * sine to sum \n \
+            sac.r   A, #0, [%[dst]++]                   ;Store sum \n \
+            ; 4 + 14 * voices cycles total, 1 DO level"
+                : [dst] "+r"(dst), [phase] "+r"(phase), [inc] "+r"(inc), [amp] "+r"(amp),
+                  [x] "=&r"(x), [s] "=&z"(s), [a] "=&z"(a) /*out*/
+                : [yTable] "r"(yTable), [voices] "r"(bank->voices - 1) /*in*/
+                : "w2", "w3", "memory" /*clobbered*/
+                );
+    }
+}
+
+/// Phase increment of MIDI note 0 (8.1758 Hz) in Q0.32 format for a given sample rate in Hz (compile-time constants only)
+#define PITCH_INC_NOTE0(fs) ((_Q32) (8.175798916 / (fs) * 4294967296.0 + 0.5))
+
+/**
+ * @brief Conversion of a pitch in semitones to a phase increment in Q0.32 format
+ *
+ * inc = incNote0 * 2^(pitch / 12) \n
+ * The pitch is split into octave, semitone and fractional semitone. The semitone ratio 2^(s / 12) / 2 is taken from a 12-point table,
+ * the fractional ratio 2^(f / 12) - 1 is interpolated from a 256-point lookup-table (see interpLUT_256_Q15()) stored with a scaling of 16.
+ * The octave is applied as a left shift of incNote0. The division by 12 is done by multiplication with 65536 / 12 (exact for pitch < 8192).
+ * The result is used as phase increment of phase accumulator oscillators, e.g. with mul_Q32_UINT() or wavetableOsc_aQ15().
+ *
+ * @note The error is less than 0.1 cent for MIDI notes 0 ... 127 at 48 kHz sample rate
+ * @note Negative pitches return incNote0, increments exceeding Q0.32 return the maximum value of Q0.32
+ * @note The DSP engine must be in the mode given by CORCON_MODE_FP_LIB (see fp_lib_corcon.h)
+ * @note This function executes in approx. 35 CPU clock cycles (using compiler option -o2)
+ * @param pitch     Pitch in semitones (MIDI note number plus pitch bend) in Q15.16 format
+ * @param incNote0  Phase increment of MIDI note 0 in Q0.32 format (see PITCH_INC_NOTE0())
+ * @return Phase increment in Q0.32 format
+ */
+inline static _Q32 pitchToInc_Q32(const _Q1516 pitch, const _Q32 incNote0)
+{
+    // Semitone ratios 2^(s / 12) / 2 in Q0.16 format, s = 0 ... 11
+    static const _Q16 semitoneTable[12] = {
+        32768U, 34716U, 36781U, 38968U, 41285U, 43740U, 46341U, 49097U, 52016U, 55109U, 58386U, 61858U
+    };
+
+    // Lookup-table of 16 * (2^(f / 12) - 1) in Q0.15 format, f = 0 ... 1
+    static const _Q15 fracTable[257] = {
+        0, 118, 237, 355, 473, 592, 710, 829, 947, 1066, 1184, 1303, 1421, 1540, 1659, 1777,
+        1896, 2015, 2134, 2252, 2371, 2490, 2609, 2728, 2847, 2966, 3085, 3204, 3323, 3442, 3561, 3680,
+        3799, 3918, 4038, 4157, 4276, 4395, 4515, 4634, 4753, 4873, 4992, 5112, 5231, 5350, 5470, 5590,
+        5709, 5829, 5948, 6068, 6188, 6307, 6427, 6547, 6667, 6786, 6906, 7026, 7146, 7266, 7386, 7506,
+        7626, 7746, 7866, 7986, 8106, 8226, 8347, 8467, 8587, 8707, 8827, 8948, 9068, 9188, 9309, 9429,
+        9550, 9670, 9791, 9911, 10032, 10152, 10273, 10394, 10514, 10635, 10756, 10876, 10997, 11118, 11239, 11360,
+        11480, 11601, 11722, 11843, 11964, 12085, 12206, 12327, 12448, 12570, 12691, 12812, 12933, 13054, 13176, 13297,
+        13418, 13539, 13661, 13782, 13904, 14025, 14147, 14268, 14390, 14511, 14633, 14754, 14876, 14998, 15119, 15241,
+        15363, 15485, 15606, 15728, 15850, 15972, 16094, 16216, 16338, 16460, 16582, 16704, 16826, 16948, 17070, 17192,
+        17315, 17437, 17559, 17681, 17804, 17926, 18048, 18171, 18293, 18416, 18538, 18660, 18783, 18906, 19028, 19151,
+        19273, 19396, 19519, 19641, 19764, 19887, 20010, 20133, 20255, 20378, 20501, 20624, 20747, 20870, 20993, 21116,
+        21239, 21362, 21485, 21609, 21732, 21855, 21978, 22102, 22225, 22348, 22472, 22595, 22718, 22842, 22965, 23089,
+        23212, 23336, 23459, 23583, 23707, 23830, 23954, 24078, 24201, 24325, 24449, 24573, 24697, 24821, 24944, 25068,
+        25192, 25316, 25440, 25564, 25688, 25813, 25937, 26061, 26185, 26309, 26434, 26558, 26682, 26806, 26931, 27055,
+        27180, 27304, 27429, 27553, 27678, 27802, 27927, 28051, 28176, 28301, 28425, 28550, 28675, 28800, 28924, 29049,
+        29174, 29299, 29424, 29549, 29674, 29799, 29924, 30049, 30174, 30299, 30424, 30549, 30675, 30800, 30925, 31050,
+        31176
+    };
+
+    if (pitch < 0)
+    {
+        return incNote0;
+    }
+
+    // Octave and semitone of the integer part of the pitch
+    const uint16_t semitones = ((Long) pitch).high;
+    const uint16_t octave = __builtin_muluu(semitones, 5462U) >> 16;
+    const uint16_t semitone = semitones - 12 * octave;
+
+    // incNote0 * 2^(octave + 1) must not exceed Q0.32
+    if ((octave > 30) || ((incNote0 >> (31 - octave)) != 0))
+    {
+        return UINT32_MAX;
+    }
+
+    // Ratio 2^((semitone + f) / 12) / 2 in Q0.16 format
+    const _Q16 ratioSemitone = semitoneTable[semitone];
+    const _Q16 ratioFrac = interpLUT_256_Q15(fracTable, ((Long) pitch).low) >> 3;
+    const uint32_t ratio = ratioSemitone + mul_Q16_Q16(ratioSemitone, ratioFrac);
+
+    return mul_Q32_Q16(incNote0 << (octave + 1), (ratio > UINT16_MAX) ? UINT16_MAX : (_Q16) ratio);
+}
+
+#endif
@@ -0,0 +1,275 @@
+/*
+Copyright (C) 2022 Andreas Lagler
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file fp_lib_pll.h
+ * @brief Phase-locked loops for grid synchronization
+ *
+ * This file is part of FP-Lib Fixed-point math library for dsPIC33 family of Microchip dsPIC digital signal controllers
+ */
+
+#ifndef FP_LIB_PLL_H
+#define	FP_LIB_PLL_H
+
+#include "fp_lib_types.h"
+#include "fp_lib_def.h"
+#include "fp_lib_add.h"
+#include "fp_lib_mul.h"
+#include "fp_lib_trig.h"
+#include "fp_lib_foc.h"
+#include "fp_lib_ctrl.h"
+
+#include <stdint.h>
+
+/**
+ * @brief Synchronous-reference-frame PLL (SRF-PLL) state
+ *
+ * The alpha/beta input is transformed to the d/q frame of the estimated angle, and a PI controller drives q to zero.
+ * The PI output is the frequency deviation, which is added to the nominal phase increment of a Q0.32 phase accumulator.
+ * In lock, d equals the input amplitude and the angle follows the phase of the alpha component, i.e. alpha = d * cos(theta).
+ *
+ * Phase increment per sample: inc = nominalInc + freq * incScale, with freq being the PI output in Q0.15 format. \n
+ * nominalInc = f0 / fs * 2^32 \n
+ * incScale = maximum frequency deviation / fs * 2^32 / 2^15, freq = 1.0 corresponds to the maximum frequency deviation
+ *
+ * Lock behavior: for small phase errors, q = V * pi * (theta_in - theta), with V the input amplitude and angles in Q0.15 format.
+ * The loop is of second order with \n
+ * omega_n = sqrt(V * pi * Kt * ki) * fs \n
+ * zeta = V * pi * Kt * kp * 2^kpShift * fs / (2 * omega_n) \n
+ * with Kt = incScale / 2^16 (angle gain per sample). The loop gains scale with V, so the input should be normalized (e.g. in per-unit).
+ * The PI output limits bound the frequency range, the anti-windup prevents false lock after phase jumps.
+ */
+typedef struct
+{
+    /// Loop filter
+    PI_Q15 pi;
+
+    /// Phase accumulator in Q0.32 format (full turn)
+    _Q32 phase;
+
+    /// Nominal phase increment per sample in Q0.32 format
+    _Q32 nominalInc;
+
+    /// Phase increment per Q0.15 LSB of frequency deviation in Q0.32 format
+    uint16_t incScale;
+
+    /// Phase increment of the last sample in Q0.32 format
+    _Q32 inc;
+
+    /// Frequency deviation (PI output) in Q0.15 format
+    _Q15 freq;
+
+    /// Estimated angle in Q0.15 format mapping [-1 ... 1[ to [-pi ... pi[
+    _Q15 theta;
+
+    /// Sine of estimated angle in Q0.15 format
+    _Q15 sinTheta;
+
+    /// Cosine of estimated angle in Q0.15 format
+    _Q15 cosTheta;
+
+    /// Input in the d/q frame of the estimated angle in Q0.15 format
+    DQ_Q15 dq;
+} SrfPll_Q15;
+
+/**
+ * @brief Reset an SRF-PLL to nominal frequency and a given angle
+ *
+ * The loop filter parameters (gains and limits) are not modified.
+ *
+ * @param pll   Pointer to SRF-PLL state
+ * @param theta Initial angle in Q0.15 format
+ */
+inline static void srfPllReset_Q15(SrfPll_Q15 * const pll, const _Q15 theta)
+{
+    piReset_Q15(&pll->pi, 0);
+    ((ULong *) &pll->phase)->high = theta;
+    ((ULong *) &pll->phase)->low = 0;
+    pll->inc = pll->nominalInc;
+    pll->freq = 0;
+    pll->theta = theta;
+    sincos_Q15(theta, &pll->sinTheta, &pll->cosTheta);
+    pll->dq.d = 0;
+    pll->dq.q = 0;
+}
+
+/**
+ * @brief SRF-PLL update with alpha/beta input
+ *
+ * The input is transformed with the angle of the last update, so the angle returned is the prediction for the next sample.
+ *
+ * @note The DSP engine must be in signed fractional mode with data space write saturation enabled (CORCON reset default)
+ * @note This function executes in approx. 60 CPU clock cycles (using compiler option -o2)
+ * @param pll   Pointer to SRF-PLL state
+ * @param ab    Pointer to alpha/beta input in Q0.15 format
+ * @return      Estimated angle for the next sample in Q0.15 format
+ */
+inline static _Q15 srfPllUpdate_Q15(SrfPll_Q15 * const pll, const AlphaBeta_Q15 * const ab)
+{
+    // Phase detector
+    parkSinCos_Q15(ab, pll->sinTheta, pll->cosTheta, &pll->dq);
+
+    // Loop filter
+    pll->freq = piUpdate_Q15(&pll->pi, pll->dq.q);
+
+    // Phase accumulator
+    pll->inc = pll->nominalInc + __builtin_mulsu(pll->freq, pll->incScale);
+    pll->phase += pll->inc;
+    pll->theta = ((ULong) pll->phase).high;
+    sincos_Q15(pll->theta, &pll->sinTheta, &pll->cosTheta);
+
+    return pll->theta;
+}
+
+/**
+ * @brief SRF-PLL update with three-phase input
+ *
+ * @note The DSP engine must be in signed fractional mode with data space write saturation enabled (CORCON reset default)
+ * @note This function executes in approx. 70 CPU clock cycles (using compiler option -o2)
+ * @param pll   Pointer to SRF-PLL state
+ * @param abc   Pointer to three-phase input in Q0.15 format
+ * @return      Estimated angle for the next sample in Q0.15 format
+ */
+inline static _Q15 srfPllUpdateABC_Q15(SrfPll_Q15 * const pll, const ABC_Q15 * const abc)
+{
+    AlphaBeta_Q15 ab;
+    clarke_Q15(abc, &ab);
+    return srfPllUpdate_Q15(pll, &ab);
+}
+
+/**
+ * @brief Second-order generalized integrator (SOGI) state
+ *
+ * Generates an in-phase (alpha) and a quadrature (beta) signal from a single-phase input v: \n
+ * alpha = alpha + g * (k * (v - alpha) - beta) \n
+ * beta = beta + g * alpha \n
+ * with g = 2 * pi * f / fs. alpha and beta are kept in Q0.31 format, so small values of g do not lose the increments to truncation.
+ * k sets the bandwidth, k = sqrt(2) is the usual trade-off between response time and harmonic rejection.
+ */
+typedef struct
+{
+    /// In-phase output in Q0.31 format
+    _Q31 alpha;
+
+    /// Quadrature output in Q0.31 format
+    _Q31 beta;
+
+    /// Half of the SOGI gain k in Q0.15 format (e.g. 23170 for k = sqrt(2))
+    _Q15 kHalf;
+} Sogi_Q15;
+
+/**
+ * @brief SOGI update
+ *
+ * The error e = k * (v - alpha) - beta is calculated in accA, so intermediate sums do not wrap around.
+ * v - alpha and e are saturated to Q0.15 when stored.
+ *
+ * @note The DSP engine must be in the mode given by CORCON_MODE_FP_LIB (see fp_lib_corcon.h)
+ * @note This function executes in approx. 35 CPU clock cycles (using compiler option -o2)
+ * @param sogi  Pointer to SOGI state
+ * @param v     Input in Q0.15 format
+ * @param g     Integrator gain 2 * pi * f / fs in Q0.15 format
+ * @param ab    Pointer to in-phase (alpha) and quadrature (beta) output in Q0.15 format
+ */
+inline static void sogiUpdate_Q15(
+                                  Sogi_Q15 * const sogi,
+                                  const _Q15 v,
+                                  const _Q15 g,
+                                  AlphaBeta_Q15 * const ab)
+{
+    const _Q15 alpha = ((Long) sogi->alpha).high;
+    const _Q15 beta = ((Long) sogi->beta).high;
+
+    // Input error v - alpha and SOGI error e = k * (v - alpha) - beta
+    _Q15 err;
+    _Q15 e;
+
+    __asm__ volatile(
+            "\
+        lac     %[v], #0, A                         ;v in A \n \
+        lac     %[alpha], #0, B                     ;alpha in B \n \
+        sub     A                                   ;v - alpha in A \n \
+        sac.r   A, #0, %[err]                       ;Store saturated v - alpha \n \
+        mpy     %[kHalf] * %[err], A                ;k / 2 * (v - alpha) in A \n \
+        sftac   A, #-1                              ;k * (v - alpha) \n \
+        lac     %[beta], #0, B                      ;beta in B \n \
+        sub     A                                   ;e = k * (v - alpha) - beta \n \
+        sac.r   A, #0, %[e]                         ;Store saturated e \n \
+        ;9 cycles total"
+            : [err] "=&z"(err), [e] "=&r"(e) /*out*/
+            : [v] "r"(v), [alpha] "r"(alpha), [beta] "r"(beta), [kHalf] "z"(sogi->kHalf) /*in*/
+            : /*clobbered*/
+            );
+
+    // Semi-implicit Euler integration
+    sogi->alpha = add_Q31_Sat(sogi->alpha, __builtin_mulss(g, e) << 1);
+    ab->alpha = ((Long) sogi->alpha).high;
+    sogi->beta = add_Q31_Sat(sogi->beta, __builtin_mulss(g, ab->alpha) << 1);
+    ab->beta = ((Long) sogi->beta).high;
+}
+
+/**
+ * @brief Single-phase PLL consisting of a SOGI quadrature generator and an SRF-PLL
+ *
+ * The SOGI is tuned to the frequency estimated by the SRF-PLL, so the quadrature signal stays at 90 degrees
+ * when the grid frequency deviates from nominal.
+ */
+typedef struct
+{
+    /// Quadrature signal generator
+    Sogi_Q15 sogi;
+
+    /// SRF-PLL
+    SrfPll_Q15 pll;
+} SogiPll_Q15;
+
+/**
+ * @brief Reset a SOGI-PLL
+ * @param spll  Pointer to SOGI-PLL state
+ * @param theta Initial angle in Q0.15 format
+ */
+inline static void sogiPllReset_Q15(SogiPll_Q15 * const spll, const _Q15 theta)
+{
+    spll->sogi.alpha = 0;
+    spll->sogi.beta = 0;
+    srfPllReset_Q15(&spll->pll, theta);
+}
+
+/**
+ * @brief SOGI-PLL update with single-phase input
+ *
+ * The SOGI gain g = 2 * pi * inc / 2^32 is derived from the phase increment of the last update.
+ *
+ * @note The DSP engine must be in signed fractional mode with data space write saturation enabled (CORCON reset default)
+ * @note The grid frequency must be below fs / (2 * pi), so g is within the range of Q0.15
+ * @note This function executes in approx. 115 CPU clock cycles (using compiler option -o2)
+ * @param spll  Pointer to SOGI-PLL state
+ * @param v     Single-phase input in Q0.15 format
+ * @return      Estimated angle for the next sample in Q0.15 format
+ */
+inline static _Q15 sogiPllUpdate_Q15(SogiPll_Q15 * const spll, const _Q15 v)
+{
+    // g = 2 * pi * inc / 2^32 = (inc * pi / 4) / 2^14 in Q0.15 format
+    const _Q32 g32 = mul_Q32_Q16(spll->pll.inc, Q16_PI_QUARTER) >> 14;
+    const _Q15 g = (g32 > INT16_MAX) ? INT16_MAX : g32;
+
+    AlphaBeta_Q15 ab;
+    sogiUpdate_Q15(&spll->sogi, v, g, &ab);
+    return srfPllUpdate_Q15(&spll->pll, &ab);
+}
+
+#endif
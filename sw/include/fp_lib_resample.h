@@ -0,0 +1,257 @@
+/*
+Copyright (C) 2022 Andreas Lagler
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file fp_lib_resample.h
+ * @brief Sample-rate conversion routines for fixed point types
+ *
+ * This file is part of FP-Lib Fixed-point math library for dsPIC33 family of Microchip dsPIC digital signal controllers
+ */
+
+#ifndef FP_LIB_RESAMPLE_H
+#define	FP_LIB_RESAMPLE_H
+
+#include "fp_lib_types.h"
+#include "fp_lib_interp.h"
+
+#include <stdint.h>
+
+/*
+ *  Both resamplers process the input in blocks. The output position is a Q16.16 number relative to the first sample of the
+ *  current input block, it advances by inc = fs_in / fs_out per output sample. An output sample at position pos is calculated
+ *  from the input samples up to index floor(pos), so an output sample is available as long as floor(pos) < len.
+ *  The increments are accumulated exactly in Q16.16 format, i.e. the ratio is rounded once to 16 fractional bits.
+ */
+
+/// Linear interpolating resampler state
+typedef struct
+{
+    /// Input samples per output sample in Q16.16 format
+    _Q1616 inc;
+
+    /// Position of the next output sample relative to the current input block in Q16.16 format
+    _Q1616 pos;
+
+    /// Last sample of the previous input block in Q0.15 format
+    _Q15 last;
+} ResampleLinear_Q15;
+
+/**
+ * @brief Initialize a linear interpolating resampler
+ * @param rs    Pointer to resampler state
+ * @param inc   Input samples per output sample (fs_in / fs_out) in Q16.16 format
+ */
+inline static void resampleLinearInit_Q15(ResampleLinear_Q15 * const rs, const _Q1616 inc)
+{
+    rs->inc = inc;
+    rs->pos = 0;
+    rs->last = 0;
+}
+
+/**
+ * @brief Linear interpolating resampler for a block of samples in Q0.15 format
+ *
+ * The output sample at position pos is interpolated between x[floor(pos) - 1] and x[floor(pos)] using interpLinear(),
+ * i.e. the output is delayed by one input sample.
+ *
+ * @note The DSP engine must be in the mode given by CORCON_MODE_FP_LIB (see fp_lib_corcon.h)
+ * @note This function executes in approx. 15 CPU clock cycles per output sample (using compiler option -o2)
+ * @param rs    Pointer to resampler state
+ * @param src   Pointer to input block in Q0.15 format
+ * @param len   Number of input samples (at least 1)
+ * @param dst   Pointer to output block in Q0.15 format, len / inc + 1 elements at maximum
+ * @return      Number of output samples written to dst
+ */
+inline static uint16_t resampleLinear_aQ15(
+                                           ResampleLinear_Q15 * const rs,
+                                           const _Q15 * const src,
+                                           const uint16_t len,
+                                           _Q15 * dst)
+{
+    ULong pos = {.value = rs->pos};
+    uint16_t cnt = 0;
+
+    while (pos.high < len)
+    {
+        const _Q15 y1 = (pos.high != 0) ? src[pos.high - 1] : rs->last;
+        *dst++ = interpLinear(y1, src[pos.high], pos.low);
+        pos.value += rs->inc;
+        ++cnt;
+    }
+
+    pos.high -= len;
+    rs->pos = pos.value;
+    rs->last = src[len - 1];
+
+    return cnt;
+}
+
+/**
+ * @brief Polyphase FIR resampler state
+ *
+ * The interpolation filter is given by a prototype lowpass h[m], m = 0 ... phases * taps - 1,
+ * designed at the rate phases * fs_in with a DC gain of phases. The phase p (0 ... phases - 1) holds
+ * coef[p][k] = h[(taps - 1 - k) * phases + p], k = 0 ... taps - 1, i.e. in the order the coefficients multiply
+ * the input samples x[floor(pos) - taps + 1] ... x[floor(pos)].
+ * The phase is selected by the log2Phases most significant bits of the fractional position (nearest lower phase).
+ */
+typedef struct
+{
+    /// Pointer to coefficients in Q0.15 format (phases x taps, phase-major), located in X data memory
+    const _Q15 * coef;
+
+    /// Number of coefficients per phase (at least 2)
+    uint16_t taps;
+
+    /// Base-2 logarithm of the number of phases (0 ... 15)
+    uint16_t log2Phases;
+
+    /// Pointer to work buffer of taps - 1 + maximum block length samples, located in Y data memory
+    _Q15 * work;
+
+    /// Input samples per output sample in Q16.16 format
+    _Q1616 inc;
+
+    /// Position of the next output sample relative to the current input block in Q16.16 format
+    _Q1616 pos;
+} ResamplePoly_Q15;
+
+/**
+ * @brief Initialize a polyphase FIR resampler
+ *
+ * The filter history in the work buffer is cleared.
+ *
+ * @param rs            Pointer to resampler state
+ * @param coef          Pointer to coefficients in Q0.15 format (phases x taps, phase-major), located in X data memory
+ * @param taps          Number of coefficients per phase (at least 2)
+ * @param log2Phases    Base-2 logarithm of the number of phases (0 ... 15)
+ * @param work          Pointer to work buffer of taps - 1 + maximum block length samples, located in Y data memory
+ * @param inc           Input samples per output sample (fs_in / fs_out) in Q16.16 format
+ */
+inline static void resamplePolyInit_Q15(
+                                        ResamplePoly_Q15 * const rs,
+                                        const _Q15 * const coef,
+                                        const uint16_t taps,
+                                        const uint16_t log2Phases,
+                                        _Q15 * const work,
+                                        const _Q1616 inc)
+{
+    rs->coef = coef;
+    rs->taps = taps;
+    rs->log2Phases = log2Phases;
+    rs->work = work;
+    rs->inc = inc;
+    rs->pos = 0;
+
+    for (uint16_t i = 0; i < taps - 1; ++i)
+    {
+        work[i] = 0;
+    }
+}
+
+/**
+ * @brief Dot product of a coefficient array and a sample array in Q0.15 format
+ * @note The result is rounded according to CORCON.RND and saturated to Q0.15
+ * @note coef must be located in X data memory, x must be located in Y data memory
+ * @note This function executes in 5 + len CPU clock cycles (using compiler option -o2)
+ * @param coef  Pointer to coefficients in Q0.15 format
+ * @param x     Pointer to samples in Q0.15 format
+ * @param len   Number of array elements (at least 2)
+ * @return      Dot product in Q0.15 format
+ */
+inline static _Q15 resampleDot_Q15(
+                                   const _Q15 * coef,
+                                   const _Q15 * x,
+                                   const uint16_t len)
+{
+    _Q15 y;
+
+    // Prefetch registers
+    _Q15 c;
+    _Q15 v;
+
+    __asm__ volatile(
+            "\
+        clr     A, [%[coef]]+=2, %[c], [%[x]]+=2, %[v] ;Prefetch first elements \n \
+        repeat  %[len]                              ;Repeat len - 1 times \n \
+        mac     %[c] * %[v], A, [%[coef]]+=2, %[c], [%[x]]+=2, %[v] ;Multiply-accumulate, prefetch next elements \n \
+        mac     %[c] * %[v], A                      ;Multiply-accumulate last elements \n \
+        sac.r   A, #0, %[y]                         ;Store result \n \
+        ;3 + len cycles total"
+            : [y] "=r"(y), [coef] "+x"(coef), [x] "+y"(x), [c] "=&z"(c), [v] "=&z"(v) /*out*/
+            : [len] "r"(len - 2) /*in*/
+            : "memory" /*clobbered*/
+            );
+
+    return y;
+}
+
+/**
+ * @brief Polyphase FIR resampler for a block of samples in Q0.15 format
+ *
+ * The input block is appended to the filter history in the work buffer, each output sample is a dot product
+ * of one coefficient phase and the last taps input samples. The output is delayed by the group delay of the prototype filter.
+ *
+ * @note The DSP engine must be in the mode given by CORCON_MODE_FP_LIB (see fp_lib_corcon.h)
+ * @note This function executes in approx. 20 + taps CPU clock cycles per output sample plus 2 cycles per input sample (using compiler option -o2)
+ * @param rs    Pointer to resampler state
+ * @param src   Pointer to input block in Q0.15 format
+ * @param len   Number of input samples (1 ... maximum block length of the work buffer)
+ * @param dst   Pointer to output block in Q0.15 format, len / inc + 1 elements at maximum
+ * @return      Number of output samples written to dst
+ */
+inline static uint16_t resamplePoly_aQ15(
+                                         ResamplePoly_Q15 * const rs,
+                                         const _Q15 * const src,
+                                         const uint16_t len,
+                                         _Q15 * dst)
+{
+    const uint16_t taps = rs->taps;
+    // Phase index = pos.low >> (16 - log2Phases), split into two shifts to allow for a single phase (shift by 16)
+    const uint16_t phaseShift = 15 - rs->log2Phases;
+    _Q15 * const work = rs->work;
+
+    // Append input block to filter history
+    for (uint16_t i = 0; i < len; ++i)
+    {
+        work[taps - 1 + i] = src[i];
+    }
+
+    ULong pos = {.value = rs->pos};
+    uint16_t cnt = 0;
+
+    while (pos.high < len)
+    {
+        const _Q15 * const coef = rs->coef + ((pos.low >> phaseShift) >> 1) * taps;
+        *dst++ = resampleDot_Q15(coef, &work[pos.high], taps);
+        pos.value += rs->inc;
+        ++cnt;
+    }
+
+    pos.high -= len;
+    rs->pos = pos.value;
+
+    // Keep the last taps - 1 input samples as filter history
+    for (uint16_t i = 0; i < taps - 1; ++i)
+    {
+        work[i] = work[len + i];
+    }
+
+    return cnt;
+}
+
+#endif
@@ -0,0 +1,211 @@
+/*
+Copyright (C) 2022 Andreas Lagler
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file fp_lib_shape.h
+ * @brief Waveshaping and soft clipping routines for fixed point types
+ *
+ * This file is part of FP-Lib Fixed-point math library for dsPIC33 family of Microchip dsPIC digital signal controllers
+ */
+
+#ifndef FP_LIB_SHAPE_H
+#define	FP_LIB_SHAPE_H
+
+#include "fp_lib_types.h"
+#include "fp_lib_interp.h"
+
+#include <stdint.h>
+
+// Odd-symmetric waveshaper table of tanh(2 * x) / tanh(2) in Q0.15 format, x = 0 ... 1
+// Soft clipper with a small-signal gain of approx. 2.07, full scale input is mapped to full scale output
+static const _Q15 shapeTanhTable_Q15[129] = {
+    0, 531, 1062, 1592, 2122, 2650, 3177, 3703, 4227, 4749, 5268, 5785, 6300, 6811, 7319, 7824,
+    8325, 8822, 9316, 9805, 10289, 10769, 11245, 11715, 12181, 12641, 13096, 13546, 13990, 14428, 14860, 15287,
+    15708, 16122, 16531, 16933, 17329, 17719, 18103, 18480, 18851, 19216, 19574, 19926, 20271, 20610, 20943, 21269,
+    21589, 21903, 22210, 22512, 22807, 23096, 23378, 23655, 23926, 24191, 24450, 24704, 24952, 25194, 25430, 25661,
+    25887, 26108, 26323, 26533, 26738, 26938, 27133, 27323, 27509, 27690, 27866, 28038, 28206, 28369, 28528, 28683,
+    28834, 28981, 29124, 29263, 29399, 29531, 29659, 29784, 29906, 30024, 30139, 30251, 30360, 30466, 30569, 30669,
+    30767, 30861, 30953, 31043, 31130, 31214, 31296, 31376, 31453, 31528, 31602, 31673, 31741, 31808, 31874, 31937,
+    31998, 32058, 32115, 32172, 32226, 32279, 32330, 32380, 32429, 32476, 32521, 32566, 32609, 32650, 32691, 32730,
+    32767
+};
+
+// Odd-symmetric waveshaper table of 1.5 * x - 0.5 * x^3 in Q0.15 format, x = 0 ... 1
+// Cubic soft clipper with a small-signal gain of 1.5 and zero slope at full scale
+static const _Q15 shapeCubicTable_Q15[129] = {
+    0, 384, 768, 1152, 1536, 1919, 2302, 2685, 3068, 3450, 3832, 4214, 4594, 4975, 5355, 5734,
+    6112, 6490, 6866, 7242, 7618, 7992, 8365, 8737, 9108, 9478, 9847, 10214, 10580, 10945, 11309, 11671,
+    12032, 12391, 12749, 13105, 13460, 13812, 14163, 14513, 14860, 15206, 15549, 15891, 16230, 16568, 16904, 17237,
+    17568, 17897, 18223, 18548, 18870, 19189, 19506, 19820, 20132, 20441, 20748, 21051, 21352, 21651, 21946, 22239,
+    22528, 22814, 23098, 23378, 23656, 23930, 24200, 24468, 24732, 24993, 25250, 25504, 25754, 26001, 26245, 26484,
+    26720, 26952, 27180, 27405, 27626, 27842, 28055, 28263, 28468, 28668, 28865, 29057, 29244, 29428, 29607, 29782,
+    29952, 30118, 30279, 30436, 30588, 30735, 30877, 31015, 31148, 31276, 31399, 31517, 31630, 31739, 31842, 31939,
+    32032, 32119, 32201, 32278, 32350, 32415, 32476, 32531, 32580, 32624, 32662, 32694, 32720, 32741, 32756, 32765,
+    32767
+};
+
+/**
+ * @brief Waveshaper of a number in Q0.15 format using a 256-point lookup-table
+ *
+ * The lookup-table covers the whole input range, i.e. yTable[0] = f(-1), yTable[128] = f(0) and yTable[256] = f(1).
+ * The signed input is mapped to the unsigned table coordinate by inverting the sign bit (see interpLUT_256_Q15()).
+ *
+ * @note The DSP engine must be in the mode given by CORCON_MODE_FP_LIB (see fp_lib_corcon.h)
+ * @note This function executes in 10 CPU clock cycles (using compiler option -o2)
+ * @note The length of the lookup-table must be 256+1 = 257
+ * @param yTable Pointer to a lookup-table holding 256+1 = 257 sampling points in Q0.15 format
+ * @param x     Input in Q0.15 format
+ * @return      Shaped output in Q0.15 format
+ */
+inline static _Q15 waveshape_Q15(
+                                 const _Q15 * const yTable,
+                                 const _Q15 x)
+{
+    return interpLUT_256_Q15(yTable, (_Q16) x ^ 0x8000U);
+}
+
+/**
+ * @brief Odd-symmetric waveshaper of a number in Q0.15 format using a 128-point lookup-table
+ *
+ * y(x) = f(|x|) for x >= 0 \n
+ * y(x) = -f(|x|) for x < 0 \n
+ * The lookup-table covers the positive half of the input range only, i.e. yTable[0] = f(0) and yTable[128] = f(1).
+ * Odd-symmetric curves (e.g. soft clippers) thus need half the table size of waveshape_Q15() at the same resolution.
+ * The interpolation is the same as in interpLUT_256_Q15(), the sign is applied to the accumulator before the result is stored.
+ *
+ * @note The DSP engine must be in the mode given by CORCON_MODE_FP_LIB (see fp_lib_corcon.h)
+ * @note This function executes in 16 CPU clock cycles (using compiler option -o2)
+ * @note The length of the lookup-table must be 128+1 = 129
+ * @param yTable Pointer to a lookup-table holding 128+1 = 129 sampling points in Q0.15 format
+ * @param x     Input in Q0.15 format
+ * @return      Shaped output in Q0.15 format
+ */
+inline static _Q15 waveshapeOdd_Q15(
+                                    const _Q15 * const yTable,
+                                    const _Q15 x)
+{
+    _Q15 y;
+    _Q15 sign;
+
+    // Dummy variables for read/write access to const parameters in inline assembly
+    _Q15 yTableDummy;
+    _Q15 xDummy;
+
+    __asm__ volatile(
+            "\
+        mov     %[x], %[sign]                       ;Save sign of x \n \
+        btsc    %[x], #15                           ;Skip if x is positive \n \
+        neg     %[x], %[x]                          ;x = |x| \n \
+        btsc    %[x], #15                           ;Skip unless x was -1.0 \n \
+        dec     %[x], %[x]                          ;Saturate |x| to 1.0 - 2^-15 \n \
+        lsr     %[x], #0x8, %[y]                    ;Table index 0..127 \n \
+        add     %[y], %[y], %[y]                    ;Double the table index for 16 bit table access \n \
+        add     %[yTable], %[y], %[yTable]          ;yTable points to y_left now \n \
+        and     #0xff, %[x]                         ;Mask fractional part of |x| \n \
+        movsac  A, [%[yTable]]+=2, %[y]             ;Prefetch y_left \n \
+        lac     %[y], #7, A                         ;Load prescaled y_left in A \n \
+        msc     %[y] * %[x], A, [%[yTable]], %[y]   ;Subtract y_left * x_frac from A, prefetch y_right \n \
+        mac     %[y] * %[x], A                      ;Add y_right * x_frac to A \n \
+        btsc    %[sign], #15                        ;Skip if x is positive \n \
+        neg     A                                   ;y(-x) = -y(x) \n \
+        sac.r   A, #-7, %[y]                        ;Store scaled A in y \n \
+        ;16 cycles total"
+            : [y] "=&z"(y), [sign] "=&r"(sign), [yTable] "=x"(yTableDummy), [x] "=z"(xDummy) /*out*/
+            : "[yTable]"(yTable), "[x]"(x) /*in*/
+            : /*clobbered*/
+            );
+
+    return y;
+}
+
+/**
+ * @brief Waveshaper of an array in Q0.15 format using a 256-point lookup-table
+ *
+ * @note The DSP engine must be in the mode given by CORCON_MODE_FP_LIB (see fp_lib_corcon.h)
+ * @note This function executes in approx. 14 CPU clock cycles per array element (using compiler option -o2)
+ * @note The length of the lookup-table must be 256+1 = 257
+ * @param yTable Pointer to a lookup-table holding 256+1 = 257 sampling points in Q0.15 format (see waveshape_Q15())
+ * @param src   Pointer to input array in Q0.15 format
+ * @param dst   Pointer to output array in Q0.15 format, may be equal to src
+ * @param len   Number of array elements
+ */
+inline static void waveshape_aQ15(
+                                  const _Q15 * const yTable,
+                                  const _Q15 * src,
+                                  _Q15 * dst,
+                                  uint16_t len)
+{
+    while (len-- > 0)
+    {
+        *dst++ = waveshape_Q15(yTable, *src++);
+    }
+}
+
+/**
+ * @brief Odd-symmetric waveshaper of an array in Q0.15 format using a 128-point lookup-table
+ *
+ * @note The DSP engine must be in the mode given by CORCON_MODE_FP_LIB (see fp_lib_corcon.h)
+ * @note This function executes in approx. 20 CPU clock cycles per array element (using compiler option -o2)
+ * @note The length of the lookup-table must be 128+1 = 129
+ * @param yTable Pointer to a lookup-table holding 128+1 = 129 sampling points in Q0.15 format (see waveshapeOdd_Q15())
+ * @param src   Pointer to input array in Q0.15 format
+ * @param dst   Pointer to output array in Q0.15 format, may be equal to src
+ * @param len   Number of array elements
+ */
+inline static void waveshapeOdd_aQ15(
+                                     const _Q15 * const yTable,
+                                     const _Q15 * src,
+                                     _Q15 * dst,
+                                     uint16_t len)
+{
+    while (len-- > 0)
+    {
+        *dst++ = waveshapeOdd_Q15(yTable, *src++);
+    }
+}
+
+/**
+ * @brief tanh-style soft clipper of a number in Q0.15 format
+ *
+ * y = tanh(2 * x) / tanh(2), interpolated from shapeTanhTable_Q15
+ *
+ * @note The DSP engine must be in the mode given by CORCON_MODE_FP_LIB (see fp_lib_corcon.h)
+ * @note This function executes in 16 CPU clock cycles (using compiler option -o2)
+ * @param x Input in Q0.15 format
+ * @return Soft clipped output in Q0.15 format
+ */
+inline static _Q15 softClipTanh_Q15(const _Q15 x)
+{
+    return waveshapeOdd_Q15(shapeTanhTable_Q15, x);
+}
+
+/**
+ * @brief Cubic soft clipper of a number in Q0.15 format
+ *
+ * y = 1.5 * x - 0.5 * x^3, interpolated from shapeCubicTable_Q15
+ *
+ * @note The DSP engine must be in the mode given by CORCON_MODE_FP_LIB (see fp_lib_corcon.h)
+ * @note This function executes in 16 CPU clock cycles (using compiler option -o2)
+ * @param x Input in Q0.15 format
+ * @return Soft clipped output in Q0.15 format
+ */
+inline static _Q15 softClipCubic_Q15(const _Q15 x)
+{
+    return waveshapeOdd_Q15(shapeCubicTable_Q15, x);
+}
+
+#endif
@@ -0,0 +1,118 @@
+/*
+Copyright (C) 2022 Andreas Lagler
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file fp_lib_sqrt.h
+ * @brief Square root routines for fixed point types
+ *
+ * This file is part of FP-Lib Fixed-point math library for dsPIC33 family of Microchip dsPIC digital signal controllers
+ */
+
+#ifndef FP_LIB_SQRT_H
+#define	FP_LIB_SQRT_H
+
+#include "fp_lib_types.h"
+#include "fp_lib_def.h"
+#include "fp_lib_mul.h"
+#include "fp_lib_interp.h"
+
+/**
+ * @brief Square root of a number in Q0.32 format
+ *
+ * The argument is normalized to x = 2^-s * m with m in [0.5 ... 1[ using ff1l.
+ * sqrt(m) is given by the chord through sqrt(0.5) and sqrt(1) plus a correction term, which is interpolated from a 256-point lookup-table
+ * (see interpLUT_256_Q15()). The correction term is stored with a scaling of 32 to retain precision.
+ * The result is scaled by 2^(-s/2), odd s are handled by an additional multiplication with 1/sqrt(2).
+ *
+ * @note The absolute error is less than 1.25 LSB of Q0.16
+ * @note This function executes in 48 CPU clock cycles (using compiler option -o2)
+ * @param x Argument in Q0.32 format
+ * @return sqrt(x) in Q0.16 format
+ */
+inline static _Q16 sqrt_Q32(const _Q32 x)
+{
+    // Lookup-table of 32 * (sqrt(0.5 + 0.5 * t) - chord(t)) in Q0.15 format, t = 0 ... 1
+    static const _Q15 table[257] = {
+        0, 247, 491, 733, 971, 1207, 1440, 1671, 1899, 2124, 2346, 2566, 2783, 2997, 3209, 3418,
+        3624, 3828, 4030, 4228, 4425, 4618, 4810, 4998, 5185, 5368, 5550, 5729, 5905, 6079, 6251, 6420,
+        6587, 6751, 6913, 7073, 7230, 7386, 7538, 7689, 7837, 7983, 8127, 8268, 8407, 8544, 8679, 8811,
+        8942, 9070, 9196, 9320, 9441, 9561, 9678, 9793, 9907, 10018, 10126, 10233, 10338, 10441, 10541, 10640,
+        10737, 10831, 10924, 11014, 11103, 11190, 11274, 11357, 11437, 11516, 11593, 11668, 11741, 11812, 11881, 11948,
+        12013, 12077, 12138, 12198, 12256, 12312, 12366, 12418, 12469, 12517, 12564, 12609, 12652, 12694, 12734, 12772,
+        12808, 12842, 12875, 12906, 12935, 12963, 12988, 13012, 13035, 13055, 13074, 13092, 13107, 13121, 13133, 13144,
+        13153, 13160, 13166, 13170, 13173, 13173, 13173, 13170, 13166, 13161, 13154, 13145, 13135, 13123, 13109, 13094,
+        13078, 13060, 13040, 13019, 12996, 12972, 12947, 12920, 12891, 12861, 12829, 12796, 12761, 12725, 12688, 12649,
+        12608, 12566, 12523, 12478, 12432, 12385, 12335, 12285, 12233, 12180, 12125, 12069, 12012, 11953, 11893, 11831,
+        11768, 11704, 11638, 11571, 11502, 11433, 11362, 11289, 11215, 11140, 11064, 10986, 10907, 10827, 10745, 10662,
+        10578, 10492, 10405, 10317, 10228, 10137, 10045, 9952, 9858, 9762, 9665, 9567, 9467, 9367, 9265, 9162,
+        9057, 8952, 8845, 8737, 8628, 8517, 8405, 8293, 8179, 8063, 7947, 7829, 7711, 7591, 7469, 7347,
+        7224, 7099, 6973, 6846, 6718, 6589, 6459, 6327, 6195, 6061, 5926, 5790, 5653, 5515, 5375, 5235,
+        5093, 4951, 4807, 4662, 4516, 4369, 4221, 4072, 3922, 3770, 3618, 3464, 3310, 3154, 2998, 2840,
+        2681, 2521, 2360, 2198, 2035, 1871, 1706, 1540, 1373, 1205, 1036, 866, 695, 523, 349, 175,
+        0
+    };
+
+    if (x == 0)
+    {
+        return 0;
+    }
+
+    const uint16_t high = ((ULong) x).high;
+    const uint16_t low = ((ULong) x).low;
+
+    // Normalization shift such that the leading one is at bit 31
+    uint16_t shift;
+
+    // Interpolation coordinate t = 2 * m - 1, i.e. the 16 bits below the leading one in Q0.16 format
+    _Q16 t;
+
+    if (high != 0)
+    {
+        shift = __builtin_ff1l(high) - 1;
+        const uint16_t mHigh = (high << shift) | ((low >> 1) >> (15 - shift));
+        const uint16_t mLow = low << shift;
+        t = (mHigh << 1) | (mLow >> 15);
+    }
+    else
+    {
+        // Left shift by 1..16 is split, as shifts by 16 are undefined
+        shift = __builtin_ff1l(low) + 15;
+        t = (low << (shift - 16)) << 1;
+    }
+
+    // sqrt(m) = chord(t) + correction term in Q0.16 format, clipped to the maximum of Q0.16
+    // The chord runs from sqrt(0.5) at t = 0 to sqrt(1) at t = 1, i.e. its slope is 1 - 1/sqrt(2)
+    const uint32_t y = (uint32_t) Q16_INV_SQRT2 + mul_Q16_Q16_Rnd(Q16_ONE_MINUS_INV_SQRT2, t) + ((interpLUT_256_Q15(table, t) + 8) >> 4);
+    _Q16 res = (y > 0xFFFF) ? 0xFFFF : y;
+
+    // Scale by 2^(-shift/2)
+    if (shift & 1)
+    {
+        res = mul_Q16_Q16_Rnd(res, Q16_INV_SQRT2);
+    }
+
+    shift >>= 1;
+    if (shift != 0)
+    {
+        // Rounded right shift
+        res = (res >> shift) + ((res >> (shift - 1)) & 1);
+    }
+
+    return res;
+}
+
+#endif
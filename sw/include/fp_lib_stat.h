@@ -0,0 +1,349 @@
+/*
+Copyright (C) 2022 Andreas Lagler
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file fp_lib_stat.h
+ * @brief Statistics routines (mean, RMS, variance) for fixed point types
+ *
+ * This file is part of FP-Lib Fixed-point math library for dsPIC33 family of Microchip dsPIC digital signal controllers
+ */
+
+#ifndef FP_LIB_STAT_H
+#define	FP_LIB_STAT_H
+
+#include "fp_lib_types.h"
+#include "fp_lib_mul.h"
+#include "fp_lib_sqrt.h"
+
+#include <stdint.h>
+
+/// Block statistics in Q0.15/Q0.31 format
+typedef struct
+{
+    /// Mean value in Q0.15 format
+    _Q15 mean;
+
+    /// Root mean square in Q0.15 format
+    _Q15 rms;
+
+    /// Variance in Q0.31 format
+    _Q31 var;
+} Stat_Q15;
+
+/**
+ * @brief Sum and sum of squares of an array in Q0.15 format
+ *
+ * The array is processed in chunks of up to 128 elements. Within a chunk, the sum is accumulated in accA
+ * and the sum of squares is accumulated in accB by sqrac. The chunk length keeps both accumulators within the 9.31 range without saturation.
+ *
+ * @note The array must be located in X data space, one element beyond the array end is read (prefetch)
+ * @note The DSP engine must be in the mode given by CORCON_MODE_FP_LIB (see fp_lib_corcon.h)
+ * @note This function executes in 13 + 2 * len CPU clock cycles per chunk of len elements (using compiler option -o2)
+ * @param src   Pointer to array in Q0.15 format
+ * @param len   Number of array elements (1 ... 32767)
+ * @param sum   Pointer to sum of array elements in Q16.15 format
+ * @param sumSq Pointer to sum of squared array elements in Q17.15 format (unsigned)
+ */
+inline static void statSums_aQ15(
+                                 const _Q15 * src,
+                                 uint16_t len,
+                                 int32_t * const sum,
+                                 uint32_t * const sumSq)
+{
+    int32_t sumRes = 0;
+    uint32_t sumSqRes = 0;
+
+    while (len > 0)
+    {
+        const uint16_t chunkLen = (len > 128) ? 128 : len;
+
+        // Chunk results
+        Long chunkSum;
+        ULong chunkSumSq;
+
+        // Prefetch register
+        _Q15 x;
+
+        __asm__ volatile(
+                "\
+            clr     A                                   ;Clear sum \n \
+            clr     B, [%[src]]+=2, %[x]                ;Clear sum of squares, prefetch first element \n \
+            do      %[len], statSums_aQ15_end_%=        ;Init Loop \n \
+            add     %[x], A                             ;Add x to sum \n \
+            statSums_aQ15_end_%=:                       ;\n \
+            sqrac   %[x] * %[x], B, [%[src]]+=2, %[x]   ;Add x * x to sum of squares, prefetch next element \n \
+            sub     #2, %[src]                          ;Undo prefetch beyond chunk end \n \
+            sftac   A, #16                              ;Sum in Q16.15 format \n \
+            sftac   B, #16                              ;Sum of squares in Q17.15 format \n \
+            mov     _ACCAL, %[sumL]                     ;Store sum \n \
+            mov     _ACCAH, %[sumH]                     ; \n \
+            mov     _ACCBL, %[sqL]                      ;Store sum of squares \n \
+            mov     _ACCBH, %[sqH]                      ; \n \
+            ; 11 + 2 * len cycles total, 1 DO level"
+                : [x] "=&z"(x), [src] "+x"(src),
+                  [sumL] "=&r"(chunkSum.low), [sumH] "=&r"(chunkSum.high),
+                  [sqL] "=&r"(chunkSumSq.low), [sqH] "=&r"(chunkSumSq.high) /*out*/
+                : [len] "r"(chunkLen - 1) /*in*/
+                : "memory" /*clobbered*/
+                );
+
+        sumRes += chunkSum.value;
+        sumSqRes += chunkSumSq.value;
+        len -= chunkLen;
+    }
+
+    *sum = sumRes;
+    *sumSq = sumSqRes;
+}
+
+/**
+ * @brief Mean square from sum of squares
+ * @note The result is saturated to Q0.31 (i.e. if all array elements are -1.0)
+ * @note This function executes in approx. 45 CPU clock cycles (using compiler option -o2)
+ * @param sumSq Sum of squared array elements in Q17.15 format, as returned by statSums_aQ15()
+ * @param len   Number of array elements (1 ... 32767)
+ * @return      Mean square in Q0.31 format
+ */
+inline static _Q31 statMeanSquare_Q31(const uint32_t sumSq, const uint16_t len)
+{
+    // Two-step 32/16 bit division yields a 32 bit quotient
+    uint16_t rem;
+    const uint16_t high = __builtin_divmodud(sumSq, len, &rem);
+    if (high > 0x7FFF)
+    {
+        return INT32_MAX;
+    }
+
+    ULong res;
+    res.high = high;
+    res.low = __builtin_divud((uint32_t) rem << 16, len);
+    return res.value;
+}
+
+/**
+ * @brief Mean value of an array in Q0.15 format
+ * @note The array must be located in X data space, one element beyond the array end is read (prefetch)
+ * @note The DSP engine must be in the mode given by CORCON_MODE_FP_LIB (see fp_lib_corcon.h)
+ * @note The result is truncated towards zero
+ * @param src   Pointer to array in Q0.15 format
+ * @param len   Number of array elements (1 ... 32767)
+ * @return      Mean value in Q0.15 format
+ */
+inline static _Q15 mean_aQ15(const _Q15 * const src, const uint16_t len)
+{
+    int32_t sum;
+    uint32_t sumSq;
+    statSums_aQ15(src, len, &sum, &sumSq);
+    return __builtin_divsd(sum, len);
+}
+
+/**
+ * @brief Root mean square of an array in Q0.15 format
+ * @note The array must be located in X data space, one element beyond the array end is read (prefetch)
+ * @note The DSP engine must be in the mode given by CORCON_MODE_FP_LIB (see fp_lib_corcon.h)
+ * @param src   Pointer to array in Q0.15 format
+ * @param len   Number of array elements (1 ... 32767)
+ * @return      Root mean square in Q0.15 format
+ */
+inline static _Q15 rms_aQ15(const _Q15 * const src, const uint16_t len)
+{
+    int32_t sum;
+    uint32_t sumSq;
+    statSums_aQ15(src, len, &sum, &sumSq);
+
+    // Mean square in Q0.31 format, shifted to Q0.32 format for the square root
+    const _Q31 meanSquare = statMeanSquare_Q31(sumSq, len);
+    return sqrt_Q32((_Q32) meanSquare << 1) >> 1;
+}
+
+/**
+ * @brief Variance of an array in Q0.15 format
+ *
+ * var = mean(x^2) - mean(x)^2
+ *
+ * @note The array must be located in X data space, one element beyond the array end is read (prefetch)
+ * @note The DSP engine must be in the mode given by CORCON_MODE_FP_LIB (see fp_lib_corcon.h)
+ * @param src   Pointer to array in Q0.15 format
+ * @param len   Number of array elements (1 ... 32767)
+ * @return      Variance in Q0.31 format
+ */
+inline static _Q31 var_aQ15(const _Q15 * const src, const uint16_t len)
+{
+    int32_t sum;
+    uint32_t sumSq;
+    statSums_aQ15(src, len, &sum, &sumSq);
+
+    const _Q15 mean = __builtin_divsd(sum, len);
+    const _Q31 var = statMeanSquare_Q31(sumSq, len) - (__builtin_mulss(mean, mean) << 1);
+    return (var < 0) ? 0 : var;
+}
+
+/**
+ * @brief Mean value, root mean square and variance of an array in Q0.15 format
+ *
+ * All three results are derived from a single pass over the array.
+ *
+ * @note The array must be located in X data space, one element beyond the array end is read (prefetch)
+ * @note The DSP engine must be in the mode given by CORCON_MODE_FP_LIB (see fp_lib_corcon.h)
+ * @param src   Pointer to array in Q0.15 format
+ * @param len   Number of array elements (1 ... 32767)
+ * @param stat  Pointer to block statistics
+ */
+inline static void stat_aQ15(const _Q15 * const src, const uint16_t len, Stat_Q15 * const stat)
+{
+    int32_t sum;
+    uint32_t sumSq;
+    statSums_aQ15(src, len, &sum, &sumSq);
+
+    const _Q15 mean = __builtin_divsd(sum, len);
+    const _Q31 meanSquare = statMeanSquare_Q31(sumSq, len);
+    const _Q31 var = meanSquare - (__builtin_mulss(mean, mean) << 1);
+
+    stat->mean = mean;
+    stat->rms = sqrt_Q32((_Q32) meanSquare << 1) >> 1;
+    stat->var = (var < 0) ? 0 : var;
+}
+
+/**
+ * @brief Exponentially weighted running statistics in Q0.15 format
+ *
+ * mean = mean + alpha * (x - mean) \n
+ * meanSquare = meanSquare + alpha * (x^2 - meanSquare)
+ *
+ * Mean and mean square are kept in Q0.31 format, so small values of alpha (i.e. long time constants) do not lose the increments to truncation.
+ * The time constant is approx. 1 / alpha samples.
+ */
+typedef struct
+{
+    /// Mean value in Q0.31 format
+    _Q31 mean;
+
+    /// Mean square in Q0.31 format
+    _Q31 meanSquare;
+
+    /// Smoothing factor in Q0.15 format
+    _Q15 alpha;
+} EwStat_Q15;
+
+/**
+ * @brief Reset exponentially weighted running statistics
+ * @param state Pointer to running statistics
+ * @param alpha Smoothing factor in Q0.15 format
+ */
+inline static void ewStatReset_Q15(EwStat_Q15 * const state, const _Q15 alpha)
+{
+    state->mean = 0;
+    state->meanSquare = 0;
+    state->alpha = alpha;
+}
+
+/**
+ * @brief Update exponentially weighted running statistics with an array in Q0.15 format
+ *
+ * Mean and mean square are restored to accA and accB, and updated by a mac/msc pair per element each.
+ *
+ * @note The DSP engine must be in the mode given by CORCON_MODE_FP_LIB (see fp_lib_corcon.h)
+ * @note This function executes in 20 + 12 * len CPU clock cycles (using compiler option -o2)
+ * @param state Pointer to running statistics
+ * @param src   Pointer to array in Q0.15 format
+ * @param len   Number of array elements (at least 1)
+ */
+inline static void ewStat_aQ15(
+                               EwStat_Q15 * const state,
+                               const _Q15 * src,
+                               const uint16_t len)
+{
+    // Array element, squared array element and previous high word of accumulator
+    _Q15 x;
+    _Q15 xSq;
+    _Q15 prev;
+
+    __asm__ volatile(
+            "\
+        mov     [%[state] + 2], %[prev]             ;Restore mean to A \n \
+        lac     %[prev], #0, A                      ; \n \
+        mov     [%[state]], %[prev]                 ; \n \
+        mov     %[prev], _ACCAL                     ; \n \
+        mov     [%[state] + 6], %[prev]             ;Restore mean square to B \n \
+        lac     %[prev], #0, B                      ; \n \
+        mov     [%[state] + 4], %[prev]             ; \n \
+        mov     %[prev], _ACCBL                     ; \n \
+        do      %[len], ewStat_aQ15_end_%=          ;Init Loop \n \
+        mov     [%[src]++], %[x]                    ;Load array element \n \
+        mul.ss  %[x], %[x], w0                      ;x^2 in Q2.30 format \n \
+        sl      w0, w0                              ;Shift x^2 to Q0.15 format \n \
+        rlc     w1, %[xSq]                          ; \n \
+        btsc    %[xSq], #15                         ;Saturate (-1.0)^2 to maximum of Q0.15 \n \
+        dec     %[xSq], %[xSq]                      ; \n \
+        sac     A, #0, %[prev]                      ;Previous mean \n \
+        mac     %[alpha] * %[x], A                  ;Add alpha * x to mean \n \
+        msc     %[alpha] * %[prev], A               ;Subtract alpha * mean from mean \n \
+        sac     B, #0, %[prev]                      ;Previous mean square \n \
+        mac     %[alpha] * %[xSq], B                ;Add alpha * x^2 to mean square \n \
+        ewStat_aQ15_end_%=:                         ;\n \
+        msc     %[alpha] * %[prev], B               ;Subtract alpha * mean square from mean square \n \
+        sac     A, #0, %[prev]                      ;Save mean \n \
+        mov     %[prev], [%[state] + 2]             ; \n \
+        mov     _ACCAL, %[prev]                     ; \n \
+        mov     %[prev], [%[state]]                 ; \n \
+        sac     B, #0, %[prev]                      ;Save mean square \n \
+        mov     %[prev], [%[state] + 6]             ; \n \
+        mov     _ACCBL, %[prev]                     ; \n \
+        mov     %[prev], [%[state] + 4]             ; \n \
+        ; 18 + 12 * len cycles total, 1 DO level"
+            : [x] "=&z"(x), [xSq] "=&z"(xSq), [prev] "=&z"(prev), [src] "+r"(src) /*out*/
+            : [alpha] "z"(state->alpha), [state] "r"(state), [len] "r"(len - 1) /*in*/
+            : "w0", "w1", "memory" /*clobbered*/
+            );
+}
+
+/**
+ * @brief Mean value of exponentially weighted running statistics
+ * @param state Pointer to running statistics
+ * @return      Mean value in Q0.15 format
+ */
+inline static _Q15 ewStatMean_Q15(const EwStat_Q15 * const state)
+{
+    return ((Long) state->mean).high;
+}
+
+/**
+ * @brief Root mean square of exponentially weighted running statistics
+ * @param state Pointer to running statistics
+ * @return      Root mean square in Q0.15 format
+ */
+inline static _Q15 ewStatRms_Q15(const EwStat_Q15 * const state)
+{
+    const _Q31 meanSquare = (state->meanSquare < 0) ? 0 : state->meanSquare;
+    return sqrt_Q32((_Q32) meanSquare << 1) >> 1;
+}
+
+/**
+ * @brief Variance of exponentially weighted running statistics
+ *
+ * var = meanSquare - mean^2
+ *
+ * @param state Pointer to running statistics
+ * @return      Variance in Q0.31 format
+ */
+inline static _Q31 ewStatVar_Q31(const EwStat_Q15 * const state)
+{
+    const _Q31 var = state->meanSquare - mul_Q31_Q31(state->mean, state->mean);
+    return (var < 0) ? 0 : var;
+}
+
+#endif
@@ -27,6 +27,44 @@ along with this program. If not, see <https://www.gnu.org/licenses/>.
 
 #include "fp_lib_types.h"
 
+// Extrapolation lookup-table for sin_Q15 and sincos_Q15
+// Organization of table is as follows
+// dy[0] y0[0] dy[1] y0[1] ... dy[511] y0[511]
+static const _Q15 sinTable_Q15[512] = {
+    804, 0, 804, 804, 802, 1608, 802, 2410, 799, 3212, 797, 4011, 794, 4808, 791, 5602,
+    786, 6393, 783, 7179, 777, 7962, 773, 8739, 766, 9512, 761, 10278, 754, 11039, 746, 11793,
+    740, 12539, 731, 13279, 722, 14010, 714, 14732, 705, 15446, 695, 16151, 684, 16846, 674, 17530,
+    664, 18204, 651, 18868, 640, 19519, 628, 20159, 616, 20787, 602, 21403, 589, 22005, 576, 22594,
+    561, 23170, 548, 23731, 532, 24279, 518, 24811, 503, 25329, 487, 25832, 471, 26319, 455, 26790,
+    438, 27245, 422, 27683, 405, 28105, 388, 28510, 370, 28898, 353, 29268, 335, 29621, 317, 29956,
+    298, 30273, 281, 30571, 261, 30852, 243, 31113, 224, 31356, 205, 31580, 186, 31785, 166, 31971,
+    148, 32137, 127, 32285, 109, 32412, 88, 32521, 69, 32609, 50, 32678, 29, 32728, 10, 32757,
+    -10, 32767, -29, 32757, -50, 32728, -69, 32678, -88, 32609, -109, 32521, -127, 32412, -148, 32285,
+    -166, 32137, -186, 31971, -205, 31785, -224, 31580, -243, 31356, -261, 31113, -281, 30852, -298, 30571,
+    -317, 30273, -335, 29956, -353, 29621, -370, 29268, -388, 28898, -405, 28510, -422, 28105, -438, 27683,
+    -455, 27245, -471, 26790, -487, 26319, -503, 25832, -518, 25329, -532, 24811, -548, 24279, -561, 23731,
+    -576, 23170, -589, 22594, -602, 22005, -616, 21403, -628, 20787, -640, 20159, -651, 19519, -664, 18868,
+    -674, 18204, -684, 17530, -695, 16846, -705, 16151, -714, 15446, -722, 14732, -731, 14010, -740, 13279,
+    -746, 12539, -754, 11793, -761, 11039, -766, 10278, -773, 9512, -777, 8739, -783, 7962, -786, 7179,
+    -791, 6393, -794, 5602, -797, 4808, -799, 4011, -802, 3212, -802, 2410, -804, 1608, -804, 804,
+    -804, 0, -804, -804, -802, -1608, -802, -2410, -799, -3212, -797, -4011, -794, -4808, -791, -5602,
+    -786, -6393, -783, -7179, -777, -7962, -773, -8739, -766, -9512, -761, -10278, -754, -11039, -746, -11793,
+    -740, -12539, -731, -13279, -722, -14010, -714, -14732, -705, -15446, -695, -16151, -684, -16846, -674, -17530,
+    -664, -18204, -651, -18868, -640, -19519, -628, -20159, -616, -20787, -602, -21403, -589, -22005, -576, -22594,
+    -561, -23170, -548, -23731, -532, -24279, -518, -24811, -503, -25329, -487, -25832, -471, -26319, -455, -26790,
+    -438, -27245, -422, -27683, -405, -28105, -388, -28510, -370, -28898, -353, -29268, -335, -29621, -317, -29956,
+    -298, -30273, -281, -30571, -261, -30852, -243, -31113, -224, -31356, -205, -31580, -186, -31785, -166, -31971,
+    -148, -32137, -127, -32285, -109, -32412, -88, -32521, -69, -32609, -50, -32678, -29, -32728, -10, -32757,
+    10, -32767, 29, -32757, 50, -32728, 69, -32678, 88, -32609, 109, -32521, 127, -32412, 148, -32285,
+    166, -32137, 186, -31971, 205, -31785, 224, -31580, 243, -31356, 261, -31113, 281, -30852, 298, -30571,
+    317, -30273, 335, -29956, 353, -29621, 370, -29268, 388, -28898, 405, -28510, 422, -28105, 438, -27683,
+    455, -27245, 471, -26790, 487, -26319, 503, -25832, 518, -25329, 532, -24811, 548, -24279, 561, -23731,
+    576, -23170, 589, -22594, 602, -22005, 616, -21403, 628, -20787, 640, -20159, 651, -19519, 664, -18868,
+    674, -18204, 684, -17530, 695, -16846, 705, -16151, 714, -15446, 722, -14732, 731, -14010, 740, -13279,
+    746, -12539, 754, -11793, 761, -11039, 766, -10278, 773, -9512, 777, -8739, 783, -7962, 786, -7179,
+    791, -6393, 794, -5602, 797, -4808, 799, -4011, 802, -3212, 802, -2410, 804, -1608, 804, -804
+};
+
 /**
  * @brief Calculation of sine of fractional argument in Q0.15 format
  *
@@ -44,46 +82,8 @@ inline static const _Q15 sin_Q15(const _Q15 x)
     // Result
     _Q15 y;
 
-    // Extrapolation lookup-table 
-    // Organization of table is as follows
-    // dy[0] y0[0] dy[1] y0[1] ... dy[511] y0[511]
-    static const _Q15 table[512] = {
-        804, 0, 804, 804, 802, 1608, 802, 2410, 799, 3212, 797, 4011, 794, 4808, 791, 5602,
-        786, 6393, 783, 7179, 777, 7962, 773, 8739, 766, 9512, 761, 10278, 754, 11039, 746, 11793,
-        740, 12539, 731, 13279, 722, 14010, 714, 14732, 705, 15446, 695, 16151, 684, 16846, 674, 17530,
-        664, 18204, 651, 18868, 640, 19519, 628, 20159, 616, 20787, 602, 21403, 589, 22005, 576, 22594,
-        561, 23170, 548, 23731, 532, 24279, 518, 24811, 503, 25329, 487, 25832, 471, 26319, 455, 26790,
-        438, 27245, 422, 27683, 405, 28105, 388, 28510, 370, 28898, 353, 29268, 335, 29621, 317, 29956,
-        298, 30273, 281, 30571, 261, 30852, 243, 31113, 224, 31356, 205, 31580, 186, 31785, 166, 31971,
-        148, 32137, 127, 32285, 109, 32412, 88, 32521, 69, 32609, 50, 32678, 29, 32728, 10, 32757,
-        -10, 32767, -29, 32757, -50, 32728, -69, 32678, -88, 32609, -109, 32521, -127, 32412, -148, 32285,
-        -166, 32137, -186, 31971, -205, 31785, -224, 31580, -243, 31356, -261, 31113, -281, 30852, -298, 30571,
-        -317, 30273, -335, 29956, -353, 29621, -370, 29268, -388, 28898, -405, 28510, -422, 28105, -438, 27683,
-        -455, 27245, -471, 26790, -487, 26319, -503, 25832, -518, 25329, -532, 24811, -548, 24279, -561, 23731,
-        -576, 23170, -589, 22594, -602, 22005, -616, 21403, -628, 20787, -640, 20159, -651, 19519, -664, 18868,
-        -674, 18204, -684, 17530, -695, 16846, -705, 16151, -714, 15446, -722, 14732, -731, 14010, -740, 13279,
-        -746, 12539, -754, 11793, -761, 11039, -766, 10278, -773, 9512, -777, 8739, -783, 7962, -786, 7179,
-        -791, 6393, -794, 5602, -797, 4808, -799, 4011, -802, 3212, -802, 2410, -804, 1608, -804, 804,
-        -804, 0, -804, -804, -802, -1608, -802, -2410, -799, -3212, -797, -4011, -794, -4808, -791, -5602,
-        -786, -6393, -783, -7179, -777, -7962, -773, -8739, -766, -9512, -761, -10278, -754, -11039, -746, -11793,
-        -740, -12539, -731, -13279, -722, -14010, -714, -14732, -705, -15446, -695, -16151, -684, -16846, -674, -17530,
-        -664, -18204, -651, -18868, -640, -19519, -628, -20159, -616, -20787, -602, -21403, -589, -22005, -576, -22594,
-        -561, -23170, -548, -23731, -532, -24279, -518, -24811, -503, -25329, -487, -25832, -471, -26319, -455, -26790,
-        -438, -27245, -422, -27683, -405, -28105, -388, -28510, -370, -28898, -353, -29268, -335, -29621, -317, -29956,
-        -298, -30273, -281, -30571, -261, -30852, -243, -31113, -224, -31356, -205, -31580, -186, -31785, -166, -31971,
-        -148, -32137, -127, -32285, -109, -32412, -88, -32521, -69, -32609, -50, -32678, -29, -32728, -10, -32757,
-        10, -32767, 29, -32757, 50, -32728, 69, -32678, 88, -32609, 109, -32521, 127, -32412, 148, -32285,
-        166, -32137, 186, -31971, 205, -31785, 224, -31580, 243, -31356, 261, -31113, 281, -30852, 298, -30571,
-        317, -30273, 335, -29956, 353, -29621, 370, -29268, 388, -28898, 405, -28510, 422, -28105, 438, -27683,
-        455, -27245, 471, -26790, 487, -26319, 503, -25832, 518, -25329, 532, -24811, 548, -24279, 561, -23731,
-        576, -23170, 589, -22594, 602, -22005, 616, -21403, 628, -20787, 640, -20159, 651, -19519, 664, -18868,
-        674, -18204, 684, -17530, 695, -16846, 705, -16151, 714, -15446, 722, -14732, 731, -14010, 740, -13279,
-        746, -12539, 754, -11793, 761, -11039, 766, -10278, 773, -9512, 777, -8739, 783, -7962, 786, -7179,
-        791, -6393, 794, -5602, 797, -4808, 799, -4011, 802, -3212, 802, -2410, 804, -1608, 804, -804
-    };
-
     // Cached table pointer
-    const _Q15 * yTable = table;
+    const _Q15 * yTable = sinTable_Q15;
 
     // Dummy variable for read/write access to const parameter in inline assembly
     _Q15 xDummy;
@@ -111,4 +111,56 @@ inline static const _Q15 sin_Q15(const _Q15 x)
     return y;
 }
 
+/**
+ * @brief Simultaneous calculation of sine and cosine of fractional argument in Q0.15 format
+ *
+ * sincos_Q15(x, s, c) returns sin(pi*x) in s and cos(pi*x) in c using the same lookup-table as sin_Q15.
+ * The table index is calculated once, the cosine index is derived by advancing it by a quarter period.
+ * 
+ * @note This function executes in 11 CPU clock cycles (using compiler option -o2)
+ * @param x Argument of sine and cosine in Q0.15 format
+ * @param s Pointer to result of sine calculation in Q0.15 format
+ * @param c Pointer to result of cosine calculation in Q0.15 format
+ */
+inline static void sincos_Q15(const _Q15 x, _Q15 * const s, _Q15 * const c)
+{
+    // Cached table pointer
+    const _Q15 * const yTable = sinTable_Q15;
+
+    // Table pointers for sine and cosine
+    const _Q15 * sTable;
+    const _Q15 * cTable;
+
+    // Dummy variable for read/write access to const parameter in inline assembly
+    _Q15 xDummy;
+
+    // Results
+    _Q15 sRes;
+    _Q15 cRes;
+
+    // Calculate results y = y0[xInt(x)] + dy * xFrac(x)) for sine and cosine
+    // cos(pi*x) = sin(pi*(x + 0.5)) --> cosine index is xInt + 64, modulo 256
+    __asm__ volatile(
+            "\
+        lsr     %[x], #0x8, %[cTable]               ;xInt = MSB of x = 0..255 \n \
+        sl      %[cTable], #2, %[cTable]            ;Quadruple xInt for access of 16 bit dy|y0 pairs \n \
+        add     %[yTable], %[cTable], %[sTable]     ;sTable points to dy[xInt] now \n \
+        add     #0x100, %[cTable]                   ;Advance by a quarter period (64 dy|y0 pairs) \n \
+        and     #0x3FF, %[cTable]                   ;Wrap around at the end of the table \n \
+        add     %[yTable], %[cTable], %[cTable]     ;cTable points to dy[xInt + 64] now \n \
+        sl      %[x], #0x8, %[x]                    ;Calculate xFrac = x - xInt in upper byte \n \
+        mul.us  %[x], [%[sTable]++], w2             ;Calculate dy[xInt] * xFrac, increment table pointer \n \
+        add     w3, [%[sTable]], %[s]               ;add y0[xInt] \n \
+        mul.us  %[x], [%[cTable]++], w2             ;Calculate dy[xInt + 64] * xFrac, increment table pointer \n \
+        add     w3, [%[cTable]], %[c]               ;add y0[xInt + 64] \n \
+        ;11 cycles total"
+            : [s] "=&r"(sRes), [c] "=&r"(cRes), [sTable] "=&r"(sTable), [cTable] "=&r"(cTable), [x] "=r"(xDummy) /*out*/
+            : "[x]" (x), [yTable] "r"(yTable) /*in*/
+            : "w2", "w3" /*clobbered*/
+            );
+
+    *s = sRes;
+    *c = cRes;
+}
+
 #endif
@@ -121,4 +121,415 @@ inline static _Q16 convert_Q1516_Q16(const _Q1516 arg)
     return res;
 }
 
+/**
+ * @brief Conversion of Q0.15 scalar to Q0.31 format
+ * @note This function executes in 1 CPU clock cycle (using compiler option -o2)
+ * @param arg Q0.15 scalar to be converted to Q0.31 format
+ * @return Conversion result in Q0.31 format
+ */
+inline static _Q31 convert_Q15_Q31(const _Q15 arg)
+{
+    Long res;
+    res.high = arg;
+    res.low = 0;
+
+    return res.value;
+}
+
+/**
+ * @brief Conversion of Q0.31 scalar to Q0.15 format
+ * @note The conversion result is truncated to Q0.15
+ * @note This function executes in 1 CPU clock cycle (using compiler option -o2)
+ * @param arg Q0.31 scalar to be converted to Q0.15 format
+ * @return Conversion result in Q0.15 format
+ */
+inline static _Q15 convert_Q31_Q15(const _Q31 arg)
+{
+    return ((Long) arg).high;
+}
+
+/**
+ * @brief Conversion of Q0.15 array to Q0.16 format
+ *
+ * Same as convert_Q15_Q16() applied element-wise
+ * @note Negative values will be clipped to zero.
+ * @note This function executes in 3 + 6 * len CPU clock cycles (using compiler option -o2)
+ * @param src   Pointer to array in Q0.15 format
+ * @param dst   Pointer to conversion result in Q0.16 format
+ * @param len   Number of array elements
+ */
+inline static void convert_aQ15_aQ16(
+                                     const _Q15 * src,
+                                     _Q16 * dst,
+                                     const uint16_t len)
+{
+    // Array element and intermediate results
+    _Q15 val;
+    _Q16 res;
+    _Q16 lsb;
+
+    __asm__ volatile(
+            "\
+        do      %[len], convert_aQ15_aQ16_end_%=    ;Init Loop \n \
+        mov     [%[src]++], %[val]                  ;Load array element \n \
+        btsc    %[val], #15                         ;Skip if val is not negative \n \
+        clr     %[val]                              ;Clip negative values to zero \n \
+        sl      %[val], %[res]                      ;Shift decimal point \n \
+        lsr     %[val], #14, %[lsb]                 ;Fill LSB to map 0x7FFF to 0xFFFF \n \
+        convert_aQ15_aQ16_end_%=:                   ;\n \
+        add     %[res], %[lsb], [%[dst]++]          ;Store result \n \
+        ; 2 + 6 * len cycles total, 1 DO level"
+            : [src] "+r"(src), [dst] "+r"(dst), [val] "=&r"(val), [res] "=&r"(res), [lsb] "=&r"(lsb) /*out*/
+            : [len] "r"(len - 1) /*in*/
+            : "memory" /*clobbered*/
+            );
+}
+
+/**
+ * @brief Conversion of Q0.16 array to Q0.15 format
+ *
+ * Same as convert_Q16_Q15() applied element-wise
+ * @note The repeat count of dsPIC33F is 14 bits wide, hence the limited array length
+ * @note This function executes in 3 + len CPU clock cycles (using compiler option -o2)
+ * @param src   Pointer to array in Q0.16 format
+ * @param dst   Pointer to conversion result in Q0.15 format
+ * @param len   Number of array elements (1 ... 16384)
+ */
+inline static void convert_aQ16_aQ15(
+                                     const _Q16 * src,
+                                     _Q15 * dst,
+                                     const uint16_t len)
+{
+    __asm__ volatile(
+            "\
+        repeat  %[len]                              ;Init Loop \n \
+        lsr     [%[src]++], [%[dst]++]              ;Shift decimal point and store result \n \
+        ; 1 + len cycles total"
+            : [src] "+r"(src), [dst] "+r"(dst) /*out*/
+            : [len] "r"(len - 1) /*in*/
+            : "memory" /*clobbered*/
+            );
+}
+
+/**
+ * @brief Conversion of Q0.16 array to Q15.16 format
+ *
+ * Same as convert_Q16_Q1516() applied element-wise
+ * @note This function executes in 3 + 2 * len CPU clock cycles (using compiler option -o2)
+ * @param src   Pointer to array in Q0.16 format
+ * @param dst   Pointer to conversion result in Q15.16 format
+ * @param len   Number of array elements
+ */
+inline static void convert_aQ16_aQ1516(
+                                       const _Q16 * src,
+                                       _Q1516 * dst,
+                                       const uint16_t len)
+{
+    __asm__ volatile(
+            "\
+        do      %[len], convert_aQ16_aQ1516_end_%=  ;Init Loop \n \
+        mov     [%[src]++], [%[dst]++]              ;Store low word \n \
+        convert_aQ16_aQ1516_end_%=:                 ;\n \
+        clr     [%[dst]++]                          ;Store zero high word \n \
+        ; 2 + 2 * len cycles total, 1 DO level"
+            : [src] "+r"(src), [dst] "+r"(dst) /*out*/
+            : [len] "r"(len - 1) /*in*/
+            : "memory" /*clobbered*/
+            );
+}
+
+/**
+ * @brief Conversion of Q15.16 array to Q0.16 format
+ *
+ * Same as convert_Q1516_Q16() applied element-wise, but the saturation is calculated without branches
+ * @note Negative values will be clipped to zero, positive values >= 1.0 will be clipped to Q0.16 maximum value (0.9999847412109375)
+ * @note This function executes in 3 + 7 * len CPU clock cycles (using compiler option -o2)
+ * @param src   Pointer to array in Q15.16 format
+ * @param dst   Pointer to conversion result in Q0.16 format
+ * @param len   Number of array elements
+ */
+inline static void convert_aQ1516_aQ16(
+                                       const _Q1516 * src,
+                                       _Q16 * dst,
+                                       const uint16_t len)
+{
+    // Low word, high word and saturation value of array element
+    _Q16 low;
+    int16_t high;
+    _Q16 sat;
+
+    __asm__ volatile(
+            "\
+        do      %[len], convert_aQ1516_aQ16_end_%=  ;Init Loop \n \
+        mov     [%[src]++], %[low]                  ;Load low word \n \
+        mov     [%[src]++], %[high]                 ;Load high word \n \
+        asr     %[high], #15, %[sat]                ;Saturation value, 0xFFFF if positive and 0x0000 if negative \n \
+        com     %[sat], %[sat]                      ; \n \
+        cpseq   %[high], %[zero]                    ;Compare high word and zero, skip if equal \n \
+        mov     %[sat], %[low]                      ;Saturate \n \
+        convert_aQ1516_aQ16_end_%=:                 ;\n \
+        mov     %[low], [%[dst]++]                  ;Store result \n \
+        ; 2 + 7 * len cycles total, 1 DO level"
+            : [src] "+r"(src), [dst] "+r"(dst), [low] "=&r"(low), [high] "=&r"(high), [sat] "=&r"(sat) /*out*/
+            : [len] "r"(len - 1), [zero] "r"(0) /*in*/
+            : "memory" /*clobbered*/
+            );
+}
+
+/**
+ * @brief Conversion of Q0.15 array to Q0.31 format
+ *
+ * Same as convert_Q15_Q31() applied element-wise
+ * @note This function executes in 3 + 2 * len CPU clock cycles (using compiler option -o2)
+ * @param src   Pointer to array in Q0.15 format
+ * @param dst   Pointer to conversion result in Q0.31 format
+ * @param len   Number of array elements
+ */
+inline static void convert_aQ15_aQ31(
+                                     const _Q15 * src,
+                                     _Q31 * dst,
+                                     const uint16_t len)
+{
+    __asm__ volatile(
+            "\
+        do      %[len], convert_aQ15_aQ31_end_%=    ;Init Loop \n \
+        clr     [%[dst]++]                          ;Store zero low word \n \
+        convert_aQ15_aQ31_end_%=:                   ;\n \
+        mov     [%[src]++], [%[dst]++]              ;Store high word \n \
+        ; 2 + 2 * len cycles total, 1 DO level"
+            : [src] "+r"(src), [dst] "+r"(dst) /*out*/
+            : [len] "r"(len - 1) /*in*/
+            : "memory" /*clobbered*/
+            );
+}
+
+/**
+ * @brief Conversion of Q0.31 array to Q0.15 format
+ *
+ * Same as convert_Q31_Q15() applied element-wise
+ * @note The conversion result is truncated to Q0.15
+ * @note This function executes in 3 + 2 * len CPU clock cycles (using compiler option -o2)
+ * @param src   Pointer to array in Q0.31 format
+ * @param dst   Pointer to conversion result in Q0.15 format
+ * @param len   Number of array elements
+ */
+inline static void convert_aQ31_aQ15(
+                                     const _Q31 * src,
+                                     _Q15 * dst,
+                                     const uint16_t len)
+{
+    __asm__ volatile(
+            "\
+        do      %[len], convert_aQ31_aQ15_end_%=    ;Init Loop \n \
+        inc2    %[src], %[src]                      ;Skip low word \n \
+        convert_aQ31_aQ15_end_%=:                   ;\n \
+        mov     [%[src]++], [%[dst]++]              ;Store high word \n \
+        ; 2 + 2 * len cycles total, 1 DO level"
+            : [src] "+r"(src), [dst] "+r"(dst) /*out*/
+            : [len] "r"(len - 1) /*in*/
+            : "memory" /*clobbered*/
+            );
+}
+
+/*
+ *  Generic conversion between fixed point formats
+ */
+
+/**
+ * @brief Format descriptor of a fixed point type
+ * @param fracBits  Number of fractional bits
+ * @param wordBits  Word size in bits (16 or 32)
+ * @param isSigned  1 for signed types, 0 for unsigned types
+ */
+#define FP_FORMAT(fracBits, wordBits, isSigned) ((fracBits) | ((wordBits) << 6) | ((isSigned) << 12))
+
+/// Format descriptor of _Q15
+#define FP_FORMAT_Q15   FP_FORMAT(15, 16, 1)
+
+/// Format descriptor of _Q16
+#define FP_FORMAT_Q16   FP_FORMAT(16, 16, 0)
+
+/// Format descriptor of _Q31
+#define FP_FORMAT_Q31   FP_FORMAT(31, 32, 1)
+
+/// Format descriptor of _Q32
+#define FP_FORMAT_Q32   FP_FORMAT(32, 32, 0)
+
+/// Format descriptor of _Q1516
+#define FP_FORMAT_Q1516 FP_FORMAT(16, 32, 1)
+
+/// Format descriptor of _Q1616
+#define FP_FORMAT_Q1616 FP_FORMAT(16, 32, 0)
+
+/// Rounding policy: truncate, i.e. round towards minus infinity
+#define FP_ROUND_TRUNC      0
+
+/// Rounding policy: round to nearest, ties rounded up
+#define FP_ROUND_NEAREST    1
+
+/// Rounding policy: round to nearest, ties rounded to even (convergent rounding)
+#define FP_ROUND_CONVERGENT 2
+
+/// Overflow policy: discard the bits exceeding the destination format (two's complement wrap-around)
+#define FP_OVERFLOW_WRAP    0
+
+/// Overflow policy: clip to the range of the destination format
+#define FP_OVERFLOW_SAT     1
+
+/**
+ * @brief Conversion between any two fixed point types with given rounding and overflow policy
+ *
+ * Example: y = FP_CONVERT(Q31, Q15, x, FP_ROUND_NEAREST, FP_OVERFLOW_SAT);
+ *
+ * The conversion maps the value exactly (up to rounding), e.g. 0x7FFF in Q0.15 format is converted to 0xFFFE in Q0.16 format.
+ * Note that convert_Q15_Q16() instead maps full scale to full scale.
+ *
+ * @param srcType   Source type without leading underscore (Q15, Q16, Q31, Q32, Q1516, Q1616)
+ * @param dstType   Destination type without leading underscore (Q15, Q16, Q31, Q32, Q1516, Q1616)
+ * @param arg       Scalar in source format
+ * @param rounding  Rounding policy (FP_ROUND_xxx)
+ * @param overflow  Overflow policy (FP_OVERFLOW_xxx)
+ * @return Conversion result in destination format
+ */
+#define FP_CONVERT(srcType, dstType, arg, rounding, overflow) \
+    ((_##dstType) convert_Generic((uint32_t) (arg), FP_FORMAT_##srcType, FP_FORMAT_##dstType, rounding, overflow))
+
+/**
+ * @brief Right shift of a 32-bit word with given rounding policy
+ * @param arg       32-bit word, sign-extended for signed types
+ * @param shift     Number of bits to shift (0..31)
+ * @param isSigned  Arithmetic shift if not zero, logical shift otherwise
+ * @param rounding  Rounding policy (FP_ROUND_xxx)
+ * @return Rounded shift result, sign-extended for signed types
+ */
+inline static uint32_t convert_ShiftRight(
+                                          const uint32_t arg,
+                                          const uint16_t shift,
+                                          const uint16_t isSigned,
+                                          const uint16_t rounding)
+{
+    if (shift == 0)
+    {
+        return arg;
+    }
+
+    uint32_t res = isSigned ? (uint32_t) ((int32_t) arg >> shift) : (arg >> shift);
+
+    // Most significant discarded bit, i.e. 0.5 LSB of the result
+    const uint32_t half = (uint32_t) 1 << (shift - 1);
+
+    if (rounding == FP_ROUND_NEAREST)
+    {
+        // Round up if the discarded bits are >= 0.5 LSB
+        res += ((arg & half) != 0);
+    }
+    else if (rounding == FP_ROUND_CONVERGENT)
+    {
+        // Round up if the discarded bits are > 0.5 LSB, or == 0.5 LSB and the result is odd
+        res += ((arg & half) != 0) && (((arg & (half - 1)) != 0) || (res & 1));
+    }
+
+    return res;
+}
+
+/**
+ * @brief Conversion between any two fixed point formats with given rounding and overflow policy
+ *
+ * All format and policy arguments are meant to be compile-time constants (see FP_CONVERT()),
+ * so the compiler removes all branches not taken. Conversions matching one of the dedicated routines
+ * (e.g. convert_Q16_Q15(), convert_Q1516_Q16()) are mapped to these routines.
+ *
+ * @param arg       Scalar in source format, sign-extended to 32 bit for signed types
+ * @param srcFormat Source format descriptor (FP_FORMAT_xxx)
+ * @param dstFormat Destination format descriptor (FP_FORMAT_xxx)
+ * @param rounding  Rounding policy (FP_ROUND_xxx), applied if fractional bits are discarded
+ * @param overflow  Overflow policy (FP_OVERFLOW_xxx)
+ * @return Conversion result in destination format, to be truncated to the destination word size
+ */
+inline static uint32_t convert_Generic(
+                                       const uint32_t arg,
+                                       const uint16_t srcFormat,
+                                       const uint16_t dstFormat,
+                                       const uint16_t rounding,
+                                       const uint16_t overflow)
+{
+    // Dedicated routines
+    if (srcFormat == dstFormat)
+    {
+        return arg;
+    }
+    if ((srcFormat == FP_FORMAT_Q16) && (dstFormat == FP_FORMAT_Q15) && (rounding == FP_ROUND_TRUNC))
+    {
+        return convert_Q16_Q15(arg);
+    }
+    if ((srcFormat == FP_FORMAT_Q16) && (dstFormat == FP_FORMAT_Q1516))
+    {
+        return convert_Q16_Q1516(arg);
+    }
+    if ((srcFormat == FP_FORMAT_Q1516) && (dstFormat == FP_FORMAT_Q16) && (rounding == FP_ROUND_TRUNC) && (overflow == FP_OVERFLOW_SAT))
+    {
+        return convert_Q1516_Q16(arg);
+    }
+    if ((srcFormat == FP_FORMAT_Q15) && (dstFormat == FP_FORMAT_Q31))
+    {
+        return convert_Q15_Q31(arg);
+    }
+    if ((srcFormat == FP_FORMAT_Q31) && (dstFormat == FP_FORMAT_Q15) && (rounding == FP_ROUND_TRUNC))
+    {
+        return convert_Q31_Q15(arg);
+    }
+
+    // Decode format descriptors
+    const uint16_t srcSigned = srcFormat >> 12;
+    const uint16_t dstSigned = dstFormat >> 12;
+    const uint16_t dstBits = (dstFormat >> 6) & 0x3F;
+    const int16_t shift = (int16_t) (dstFormat & 0x3F) - (int16_t) (srcFormat & 0x3F);
+
+    // Range of destination format
+    const uint32_t dstMax = UINT32_MAX >> (32 - dstBits + dstSigned);
+    const int32_t dstMin = dstSigned ? -(int32_t) dstMax - 1 : 0;
+
+    if (shift > 0)
+    {
+        // Left shift, saturate before shifting
+        if (overflow == FP_OVERFLOW_SAT)
+        {
+            if (srcSigned)
+            {
+                if ((int32_t) arg < (dstMin >> shift))
+                {
+                    return dstMin;
+                }
+                if (((int32_t) arg > 0) && (arg > (dstMax >> shift)))
+                {
+                    return dstMax;
+                }
+            }
+            else if (arg > (dstMax >> shift))
+            {
+                return dstMax;
+            }
+        }
+
+        return arg << shift;
+    }
+
+    // Right shift with rounding, saturate after shifting
+    const uint32_t res = convert_ShiftRight(arg, -shift, srcSigned, rounding);
+
+    if (overflow == FP_OVERFLOW_SAT)
+    {
+        if (srcSigned && ((int32_t) res < dstMin))
+        {
+            return dstMin;
+        }
+        if ((!srcSigned || ((int32_t) res >= 0)) && (res > dstMax))
+        {
+            return dstMax;
+        }
+    }
+
+    return res;
+}
+
 #endif
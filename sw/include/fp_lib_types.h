@@ -36,12 +36,38 @@ typedef int16_t _Q15;
 /// Type definition for Q0.32 unsigned fractional number
 typedef uint32_t _Q32;
 
+/// Type definition for Q0.31 signed fractional number
+typedef int32_t _Q31;
+
 /// Type definition for Q16.16 unsigned fractional number
 typedef uint32_t _Q1616;
 
 /// Type definition for Q15.16 signed fractional number
 typedef int32_t _Q1516;
 
+/// Type definition for complex number in Q0.15 format, real and imaginary part packed in consecutive words
+typedef struct
+{
+    /// Real part
+    _Q15 re;
+
+    /// Imaginary part
+    _Q15 im;
+} _CQ15;
+
+/// Type definition for the 40-bit content of a DSP accumulator in the layout of ACCxL, ACCxH, ACCxU
+typedef struct
+{
+    /// Bits 0..15 (ACCxL)
+    uint16_t low;
+
+    /// Bits 16..31 (ACCxH)
+    uint16_t high;
+
+    /// Sign-extended bits 32..39 (ACCxU)
+    int16_t upper;
+} Acc40;
+
 ////////////////////////////////////////////////////////////////////////////
 // Union typedefs for upper/lower word access within a long
 // allowing for easy access of integer and fractional parts of a Q16.16 or Q15.16 fractional number